@@ -0,0 +1,433 @@
+#include <common/bench.hpp>
+#include <core/error.hpp>
+
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+
+// Linear buckets per power of two, must be a power of two itself
+#define VSOCK_BENCH_SUB_BUCKETS 64
+#define VSOCK_BENCH_SUB_BITS 6
+#define VSOCK_BENCH_BUCKETS_COUNT (VSOCK_BENCH_SUB_BUCKETS * (64 - VSOCK_BENCH_SUB_BITS + 1))
+
+namespace vsock::bench {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Options class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    Options::Options(const int argc, char** argv) {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg(argv[i]);
+            if (arg.rfind("--", 0) != 0) {
+                throw RuntimeError(
+                    "Method: Options::Options()"s,
+                    "Message: unexpected argument "s + arg
+                );
+            }
+            const std::size_t eq = arg.find('=');
+            if (eq == std::string::npos) {
+                values_[arg.substr(2)] = "1";
+            }
+            else {
+                values_[arg.substr(2, eq - 2)] = arg.substr(eq + 1);
+            }
+        }
+    }
+
+    bool Options::Has(const std::string& name) const {
+        return values_.contains(name);
+    }
+
+    std::string Options::Get(const std::string& name, const std::string& fallback) const {
+        auto it = values_.find(name);
+        return it == values_.end() ? fallback : it->second;
+    }
+
+    std::size_t Options::GetSize(const std::string& name, const std::size_t fallback) const {
+        auto it = values_.find(name);
+        if (it == values_.end()) {
+            return fallback;
+        }
+        try {
+            return static_cast<std::size_t>(std::stoull(it->second));
+        }
+        catch (const std::exception&) {
+            throw RuntimeError(
+                "Method: Options::GetSize()"s,
+                "Message: --"s + name + " expects a number"s
+            );
+        }
+    }
+
+    double Options::GetDouble(const std::string& name, const double fallback) const {
+        auto it = values_.find(name);
+        if (it == values_.end()) {
+            return fallback;
+        }
+        try {
+            return std::stod(it->second);
+        }
+        catch (const std::exception&) {
+            throw RuntimeError(
+                "Method: Options::GetDouble()"s,
+                "Message: --"s + name + " expects a number"s
+            );
+        }
+    }
+
+    std::vector<std::size_t> Options::GetSizes(const std::string& name, const std::string& fallback) const {
+        std::vector<std::size_t> result;
+        std::stringstream list(Get(name, fallback));
+        std::string item;
+        while (std::getline(list, item, ',')) {
+            try {
+                result.push_back(static_cast<std::size_t>(std::stoull(item)));
+            }
+            catch (const std::exception&) {
+                throw RuntimeError(
+                    "Method: Options::GetSizes()"s,
+                    "Message: --"s + name + " expects a comma separated list of numbers"s
+                );
+            }
+        }
+        return result;
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Histogram class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    Histogram::Histogram() :
+        counts_(VSOCK_BENCH_BUCKETS_COUNT, 0),
+        count_{ 0 },
+        max_{ 0 },
+        sum_{ 0 }
+    {}
+
+    void Histogram::Record(const std::uint64_t value) noexcept {
+        ++counts_[Index_(value)];
+        ++count_;
+        max_ = std::max(max_, value);
+        sum_ += value;
+    }
+
+    void Histogram::RecordCorrected(const std::uint64_t value, const std::uint64_t interval) noexcept {
+        Record(value);
+        if (!interval) {
+            return;
+        }
+        for (std::uint64_t missed = value > interval ? value - interval : 0; missed >= interval; missed -= interval) {
+            Record(missed);
+        }
+    }
+
+    void Histogram::Merge(const Histogram& other) noexcept {
+        for (std::size_t i = 0; i < counts_.size(); ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        count_ += other.count_;
+        max_ = std::max(max_, other.max_);
+        sum_ += other.sum_;
+    }
+
+    void Histogram::Reset() noexcept {
+        std::fill(counts_.begin(), counts_.end(), 0);
+        count_ = 0;
+        max_ = 0;
+        sum_ = 0;
+    }
+
+    std::uint64_t Histogram::Count() const noexcept {
+        return count_;
+    }
+
+    std::uint64_t Histogram::Max() const noexcept {
+        return max_;
+    }
+
+    double Histogram::Mean() const noexcept {
+        return count_ ? static_cast<double>(sum_ / count_) : 0.0;
+    }
+
+    std::uint64_t Histogram::Percentile(const double percentile) const noexcept {
+        if (!count_) {
+            return 0;
+        }
+        const std::uint64_t rank = std::max<std::uint64_t>(
+            1, static_cast<std::uint64_t>(static_cast<long double>(count_) * percentile / 100.0L + 0.5L)
+        );
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < counts_.size(); ++i) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                return std::min(Upper_(i), max_);
+            }
+        }
+        return max_;
+    }
+
+    std::size_t Histogram::Index_(const std::uint64_t value) noexcept {
+        if (value < VSOCK_BENCH_SUB_BUCKETS) {
+            return static_cast<std::size_t>(value);
+        }
+        // Top VSOCK_BENCH_SUB_BITS bits below the leading one pick the bucket
+        const std::size_t shift = static_cast<std::size_t>(std::bit_width(value)) - VSOCK_BENCH_SUB_BITS - 1;
+        return VSOCK_BENCH_SUB_BUCKETS * (shift + 1) + static_cast<std::size_t>((value >> shift) - VSOCK_BENCH_SUB_BUCKETS);
+    }
+
+    std::uint64_t Histogram::Upper_(const std::size_t index) noexcept {
+        if (index < VSOCK_BENCH_SUB_BUCKETS) {
+            return index;
+        }
+        const std::size_t shift = index / VSOCK_BENCH_SUB_BUCKETS - 1;
+        const std::uint64_t sub = index % VSOCK_BENCH_SUB_BUCKETS + VSOCK_BENCH_SUB_BUCKETS;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Report class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    Report::Report(const std::string& bench) {
+        Add("bench", bench);
+    }
+
+    Report& Report::Add(const std::string& key, const std::string& value) {
+        fields_.emplace_back(key, value);
+        quoted_.push_back(true);
+        return *this;
+    }
+
+    Report& Report::Add(const std::string& key, const std::uint64_t value) {
+        fields_.emplace_back(key, std::to_string(value));
+        quoted_.push_back(false);
+        return *this;
+    }
+
+    Report& Report::Add(const std::string& key, const double value) {
+        char text[64];
+        std::snprintf(text, sizeof(text), "%.3f", value);
+        fields_.emplace_back(key, text);
+        quoted_.push_back(false);
+        return *this;
+    }
+
+    Report& Report::AddLatency(const Histogram& histogram, const std::string& prefix) {
+        Add(prefix + "p50_us", static_cast<double>(histogram.Percentile(50.0)) / 1000.0);
+        Add(prefix + "p99_us", static_cast<double>(histogram.Percentile(99.0)) / 1000.0);
+        Add(prefix + "p999_us", static_cast<double>(histogram.Percentile(99.9)) / 1000.0);
+        Add(prefix + "max_us", static_cast<double>(histogram.Max()) / 1000.0);
+        return *this;
+    }
+
+    void Report::Print(const bool json) const {
+        std::string line;
+        if (json) {
+            line.push_back('{');
+            for (std::size_t i = 0; i < fields_.size(); ++i) {
+                if (i) {
+                    line.push_back(',');
+                }
+                line += "\"" + fields_[i].first + "\":";
+                line += quoted_[i] ? "\"" + fields_[i].second + "\"" : fields_[i].second;
+            }
+            line.push_back('}');
+        }
+        else {
+            for (std::size_t i = 0; i < fields_.size(); ++i) {
+                if (i) {
+                    line.push_back(' ');
+                }
+                line += fields_[i].first + "=" + fields_[i].second;
+            }
+        }
+        std::printf("%s\n", line.c_str());
+        std::fflush(stdout);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Helpers
+    //////////////////////////////////////////////////////////////////////////////////
+
+    endpoint_t ParseEndpoint(const std::string& address) {
+        const std::size_t colon = address.find(':');
+        const std::string scheme = address.substr(0, colon);
+        const std::string rest = colon == std::string::npos ? ""s : address.substr(colon + 1);
+        if (scheme == "tcp") {
+            return { Transport::TCP, ""s, static_cast<std::uint16_t>(rest.empty() ? 0 : std::stoul(rest)) };
+        }
+        if (scheme == "unix") {
+            return { Transport::UNIX, rest.empty() ? "/tmp/vsock-bench-"s + std::to_string(::getpid()) + ".sock"s : rest, 0 };
+        }
+        throw RuntimeError(
+            "Method: ParseEndpoint()"s,
+            "Message: unknown transport in "s + address
+        );
+    }
+
+    std::string FormatEndpoint(const endpoint_t& endpoint) {
+        if (endpoint.transport == Transport::TCP) {
+            return "tcp:"s + std::to_string(endpoint.port);
+        }
+        return "unix:"s + endpoint.path;
+    }
+
+    const char* TransportName(const Transport transport) noexcept {
+        return transport == Transport::TCP ? "tcp" : "unix";
+    }
+
+    SocketID Listen(endpoint_t& endpoint, const int backlog) {
+        SocketID socket_id = VSOCK_INVALID_SOCKET;
+        if (endpoint.transport == Transport::TCP) {
+            socket_id = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+            int reuse = 1;
+            ::setsockopt(socket_id, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+            sockaddr_in service{};
+            service.sin_family = AF_INET;
+            service.sin_port = htons(endpoint.port);
+            service.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            if (::bind(socket_id, reinterpret_cast<sockaddr*>(&service), sizeof(service)) == VSOCK_SOCKET_ERROR) {
+                closesocket(socket_id);
+                socket_id = VSOCK_INVALID_SOCKET;
+            }
+            else {
+                socklen_t length = sizeof(service);
+                ::getsockname(socket_id, reinterpret_cast<sockaddr*>(&service), &length);
+                endpoint.port = ntohs(service.sin_port);
+            }
+        }
+        else {
+            socket_id = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            sockaddr_un service{};
+            service.sun_family = AF_UNIX;
+            std::snprintf(service.sun_path, sizeof(service.sun_path), "%s", endpoint.path.c_str());
+            ::unlink(endpoint.path.c_str());
+            if (::bind(socket_id, reinterpret_cast<sockaddr*>(&service), sizeof(service)) == VSOCK_SOCKET_ERROR) {
+                closesocket(socket_id);
+                socket_id = VSOCK_INVALID_SOCKET;
+            }
+        }
+        if (socket_id == VSOCK_INVALID_SOCKET || ::listen(socket_id, backlog) == VSOCK_SOCKET_ERROR) {
+            throw RuntimeError(
+                "Method: Listen()"s,
+                "Message: cannot listen on "s + FormatEndpoint(endpoint)
+            );
+        }
+        SetNonBlocking(socket_id);
+        return socket_id;
+    }
+
+    SocketID Connect(const endpoint_t& endpoint, const bool non_blocking) {
+        SocketID socket_id = VSOCK_INVALID_SOCKET;
+        int result = VSOCK_SOCKET_ERROR;
+        if (endpoint.transport == Transport::TCP) {
+            socket_id = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+            int no_delay = 1;
+            ::setsockopt(socket_id, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+            sockaddr_in service{};
+            service.sin_family = AF_INET;
+            service.sin_port = htons(endpoint.port);
+            service.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            result = ::connect(socket_id, reinterpret_cast<sockaddr*>(&service), sizeof(service));
+        }
+        else {
+            socket_id = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            sockaddr_un service{};
+            service.sun_family = AF_UNIX;
+            std::snprintf(service.sun_path, sizeof(service.sun_path), "%s", endpoint.path.c_str());
+            result = ::connect(socket_id, reinterpret_cast<sockaddr*>(&service), sizeof(service));
+        }
+        if (result == VSOCK_SOCKET_ERROR) {
+            // Keep the connect() errno for the error report
+            const int error = errno;
+            closesocket(socket_id);
+            errno = error;
+            throw RuntimeError(
+                "Method: Connect()"s,
+                "Message: cannot connect to "s + FormatEndpoint(endpoint)
+            );
+        }
+        if (non_blocking) {
+            SetNonBlocking(socket_id);
+        }
+        return socket_id;
+    }
+
+    void SetNonBlocking(const SocketID socket_id) {
+        const int fl = ::fcntl(socket_id, F_GETFL, 0);
+        if (fl == -1 || ::fcntl(socket_id, F_SETFL, fl | O_NONBLOCK) == -1) {
+            throw RuntimeError(
+                "Method: SetNonBlocking()"s,
+                "Message: switch to non-blocking mode failed"s
+            );
+        }
+    }
+
+    void EncodeHeader(char* data, const frame_header_t& header) noexcept {
+        const std::uint32_t length = htonl(header.length);
+        const std::uint32_t reply = htonl(header.reply);
+        std::memcpy(data, &length, sizeof(length));
+        std::memcpy(data + sizeof(length), &reply, sizeof(reply));
+    }
+
+    frame_header_t DecodeHeader(const char* data) noexcept {
+        std::uint32_t length;
+        std::uint32_t reply;
+        std::memcpy(&length, data, sizeof(length));
+        std::memcpy(&reply, data + sizeof(length), sizeof(reply));
+        return { ntohl(length), ntohl(reply) };
+    }
+
+    bool SendAll(const SocketID socket_id, const char* data, const std::size_t size) {
+        std::size_t sent = 0;
+        while (sent < size) {
+            const ssize_t result = ::send(socket_id, data + sent, size - sent, MSG_NOSIGNAL);
+            if (result > 0) {
+                sent += static_cast<std::size_t>(result);
+                continue;
+            }
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            if (result < 0 && VSOCK_WOULD_BLOCK()) {
+                pollfd pfd{ socket_id, POLLOUT, 0 };
+                ::poll(&pfd, 1, -1);
+                continue;
+            }
+            return false;
+        }
+        return true;
+    }
+
+    bool RecvAll(const SocketID socket_id, char* data, const std::size_t size) {
+        std::size_t received = 0;
+        while (received < size) {
+            const ssize_t result = ::recv(socket_id, data + received, size - received, 0);
+            if (result > 0) {
+                received += static_cast<std::size_t>(result);
+                continue;
+            }
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            if (result < 0 && VSOCK_WOULD_BLOCK()) {
+                pollfd pfd{ socket_id, POLLIN, 0 };
+                ::poll(&pfd, 1, -1);
+                continue;
+            }
+            return false;
+        }
+        return true;
+    }
+
+    std::uint64_t Nanoseconds(const Clock::duration duration) noexcept {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+    }
+
+}
@@ -0,0 +1,159 @@
+#ifndef INCLUDE_GUARD_VSOCK_BENCH_HPP
+#define INCLUDE_GUARD_VSOCK_BENCH_HPP
+
+#include <core/common.hpp>
+#include <core/error.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include <unordered_map>
+
+// Wire header of the benchmark framing, see frame_header_t
+#define VSOCK_BENCH_HEADER_SIZE 8
+
+namespace vsock::bench {
+
+    using Clock = std::chrono::steady_clock;
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Options class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Command line of the form --name=value, a bare --name reads as "1".
+    // List options take comma separated values and are expanded by the caller.
+    class Options {
+    public:
+
+        Options() = delete;
+        Options(const Options&) = delete;
+        Options(Options&&) = delete;
+        Options& operator=(const Options&) = delete;
+        Options& operator=(Options&&) = delete;
+
+    public:
+
+        Options(const int argc, char** argv);
+
+        bool Has(const std::string& name) const;
+        std::string Get(const std::string& name, const std::string& fallback) const;
+        std::size_t GetSize(const std::string& name, const std::size_t fallback) const;
+        double GetDouble(const std::string& name, const double fallback) const;
+        std::vector<std::size_t> GetSizes(const std::string& name, const std::string& fallback) const;
+
+    private:
+
+        std::unordered_map<std::string, std::string> values_;
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Histogram class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Log-linear latency histogram in nanoseconds: every power of two is split
+    // into 64 linear buckets, so any percentile is within ~1.6% of the value
+    class Histogram {
+    public:
+
+        Histogram();
+
+        void Record(const std::uint64_t value) noexcept;
+        // Also records the samples a closed loop failed to send while it
+        // waited, one per missed interval (coordinated omission correction)
+        void RecordCorrected(const std::uint64_t value, const std::uint64_t interval) noexcept;
+        void Merge(const Histogram& other) noexcept;
+        void Reset() noexcept;
+
+        std::uint64_t Count() const noexcept;
+        std::uint64_t Max() const noexcept;
+        double Mean() const noexcept;
+        std::uint64_t Percentile(const double percentile) const noexcept;
+
+    private:
+
+        static std::size_t Index_(const std::uint64_t value) noexcept;
+        static std::uint64_t Upper_(const std::size_t index) noexcept;
+
+    private:
+
+        std::vector<std::uint64_t> counts_;
+        std::uint64_t count_;
+        std::uint64_t max_;
+        long double sum_;
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Report class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // One result row, printed as key=value text or as a single JSON object per line
+    class Report {
+    public:
+
+        explicit Report(const std::string& bench);
+
+        Report& Add(const std::string& key, const std::string& value);
+        Report& Add(const std::string& key, const std::uint64_t value);
+        Report& Add(const std::string& key, const double value);
+        Report& AddLatency(const Histogram& histogram, const std::string& prefix = ""s);
+
+        void Print(const bool json) const;
+
+    private:
+
+        std::vector<std::pair<std::string, std::string>> fields_;
+        // Values that must stay quoted in JSON
+        std::vector<bool> quoted_;
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Helpers
+    //////////////////////////////////////////////////////////////////////////////////
+
+    enum class Transport : std::uint8_t {
+        TCP,
+        UNIX
+    };
+
+    typedef struct {
+        Transport transport;
+        std::string path;
+        std::uint16_t port;
+    } endpoint_t;
+
+    // Every message is a header followed by length payload bytes. The server
+    // answers each request with a frame of reply payload bytes, an echo
+    // request simply asks for reply == length.
+    typedef struct {
+        std::uint32_t length;
+        std::uint32_t reply;
+    } frame_header_t;
+
+    // "tcp:PORT", "unix:PATH" or plain "tcp"/"unix" for an ephemeral address
+    endpoint_t ParseEndpoint(const std::string& address);
+    std::string FormatEndpoint(const endpoint_t& endpoint);
+    const char* TransportName(const Transport transport) noexcept;
+
+    // Binds to loopback, an ephemeral TCP port is written back to endpoint
+    SocketID Listen(endpoint_t& endpoint, const int backlog);
+    SocketID Connect(const endpoint_t& endpoint, const bool non_blocking);
+    void SetNonBlocking(const SocketID socket_id);
+
+    void EncodeHeader(char* data, const frame_header_t& header) noexcept;
+    frame_header_t DecodeHeader(const char* data) noexcept;
+
+    // Blocking helpers for client threads, false once the peer is gone
+    bool SendAll(const SocketID socket_id, const char* data, const std::size_t size);
+    bool RecvAll(const SocketID socket_id, char* data, const std::size_t size);
+
+    std::uint64_t Nanoseconds(const Clock::duration duration) noexcept;
+
+}
+
+#endif // INCLUDE_GUARD_VSOCK_BENCH_HPP
@@ -0,0 +1,124 @@
+#include <common/client.hpp>
+
+#include <atomic>
+#include <cerrno>
+#include <deque>
+#include <thread>
+
+#include <poll.h>
+
+namespace vsock::bench {
+
+    namespace {
+
+        // Non-blocking client, reads and writes are interleaved so a server
+        // that stops reading to flush large replies is always drained
+        void Client(
+            const endpoint_t& endpoint,
+            const load_t& load,
+            const std::atomic<bool>& recording,
+            const std::atomic<bool>& stopping,
+            load_result_t& result
+        ) {
+            const SocketID socket_id = Connect(endpoint, true);
+            std::vector<char> request(VSOCK_BENCH_HEADER_SIZE + load.size, 'x');
+            const std::size_t response_size = VSOCK_BENCH_HEADER_SIZE + load.reply;
+            EncodeHeader(request.data(), { static_cast<std::uint32_t>(load.size), static_cast<std::uint32_t>(load.reply) });
+            std::deque<Clock::time_point> sent;
+
+            // Requests not on the wire yet, only the first one can be partly written
+            std::size_t queued = 0;
+            std::size_t written = 0;
+            std::size_t received = 0;
+            for (std::size_t i = 0; i < load.depth; ++i) {
+                sent.push_back(Clock::now());
+                ++queued;
+            }
+
+            bool alive = true;
+            while (alive && !stopping.load(std::memory_order_relaxed)) {
+                pollfd pfd{ socket_id, static_cast<short>(POLLIN | (queued ? POLLOUT : 0)), 0 };
+                if (::poll(&pfd, 1, 100) <= 0) {
+                    continue;
+                }
+
+                while (queued) {
+                    const ssize_t count = ::send(
+                        socket_id, request.data() + written, request.size() - written, MSG_NOSIGNAL
+                    );
+                    if (count <= 0) {
+                        alive = count < 0 && (errno == EINTR || VSOCK_WOULD_BLOCK());
+                        break;
+                    }
+                    written += static_cast<std::size_t>(count);
+                    if (written == request.size()) {
+                        written = 0;
+                        --queued;
+                    }
+                }
+
+                // Replies are fixed size, only how much of the current one arrived matters
+                while (alive) {
+                    char buffer[65536];
+                    const ssize_t count = ::recv(socket_id, buffer, sizeof(buffer), 0);
+                    if (count <= 0) {
+                        alive = count < 0 && (errno == EINTR || VSOCK_WOULD_BLOCK());
+                        break;
+                    }
+                    received += static_cast<std::size_t>(count);
+                    while (received >= response_size) {
+                        received -= response_size;
+                        const Clock::time_point now = Clock::now();
+                        if (recording.load(std::memory_order_relaxed)) {
+                            result.latency.Record(Nanoseconds(now - sent.front()));
+                            ++result.messages;
+                            result.bytes += load.size + load.reply;
+                        }
+                        sent.pop_front();
+                        sent.push_back(now);
+                        ++queued;
+                    }
+                }
+            }
+            ::shutdown(socket_id, SHUT_WR);
+            closesocket(socket_id);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Helpers
+    //////////////////////////////////////////////////////////////////////////////////
+
+    load_result_t RunClosedLoop(const endpoint_t& endpoint, const load_t& load) {
+        std::atomic<bool> recording{ false };
+        std::atomic<bool> stopping{ false };
+        std::vector<load_result_t> results(load.connections, load_result_t{ {}, 0, 0, 0.0 });
+        std::vector<std::thread> clients;
+        for (std::size_t i = 0; i < load.connections; ++i) {
+            clients.emplace_back(
+                Client, std::cref(endpoint), std::cref(load),
+                std::cref(recording), std::cref(stopping), std::ref(results[i])
+            );
+        }
+
+        std::this_thread::sleep_for(std::chrono::duration<double>(load.warmup));
+        const Clock::time_point start = Clock::now();
+        recording = true;
+        std::this_thread::sleep_for(std::chrono::duration<double>(load.duration));
+        recording = false;
+        const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        stopping = true;
+        for (std::thread& client : clients) {
+            client.join();
+        }
+
+        load_result_t total{ {}, 0, 0, elapsed };
+        for (const load_result_t& result : results) {
+            total.latency.Merge(result.latency);
+            total.messages += result.messages;
+            total.bytes += result.bytes;
+        }
+        return total;
+    }
+
+}
@@ -0,0 +1,34 @@
+#ifndef INCLUDE_GUARD_VSOCK_BENCH_CLIENT_HPP
+#define INCLUDE_GUARD_VSOCK_BENCH_CLIENT_HPP
+
+#include <common/bench.hpp>
+
+namespace vsock::bench {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Helpers
+    //////////////////////////////////////////////////////////////////////////////////
+
+    typedef struct {
+        std::size_t connections;
+        std::size_t size;
+        std::size_t reply;
+        std::size_t depth;
+        double warmup;
+        double duration;
+    } load_t;
+
+    typedef struct {
+        Histogram latency;
+        std::uint64_t messages;
+        std::uint64_t bytes;
+        double seconds;
+    } load_result_t;
+
+    // Closed loop from one client thread per connection, each keeps depth
+    // requests in flight and sends the next one per reply
+    load_result_t RunClosedLoop(const endpoint_t& endpoint, const load_t& load);
+
+}
+
+#endif // INCLUDE_GUARD_VSOCK_BENCH_CLIENT_HPP
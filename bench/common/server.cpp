@@ -0,0 +1,147 @@
+#include <common/server.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+namespace vsock::bench {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // BenchServer class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    BenchServer::BenchServer(PollManager* const poll, const endpoint_t& endpoint, const bool inline_dispatch) :
+        poll_{ poll },
+        endpoint_{ endpoint },
+        inline_dispatch_{ inline_dispatch },
+        listen_id_{ VSOCK_INVALID_SOCKET },
+        requests_{ 0 }
+    {
+        listen_id_ = Listen(endpoint_, 4096);
+        poll_->Add(listen_id_, EPOLLIN | EPOLLONESHOT, [this](const SocketID socket_id) {
+            Accept_(socket_id);
+        }, PollManager::Priority::HIGH);
+    }
+
+    BenchServer::~BenchServer() {
+        if (endpoint_.transport == Transport::UNIX) {
+            ::unlink(endpoint_.path.c_str());
+        }
+    }
+
+    const endpoint_t& BenchServer::Endpoint() const noexcept {
+        return endpoint_;
+    }
+
+    std::uint64_t BenchServer::Requests() const noexcept {
+        return requests_.load(std::memory_order_relaxed);
+    }
+
+    void BenchServer::Accept_(const SocketID listen_id) {
+        while (true) {
+            const SocketID client_id = ::accept(listen_id, nullptr, nullptr);
+            if (client_id == VSOCK_INVALID_SOCKET) {
+                break;
+            }
+            SetNonBlocking(client_id);
+            if (endpoint_.transport == Transport::TCP) {
+                int no_delay = 1;
+                ::setsockopt(client_id, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+            }
+            // EPOLLONESHOT keeps a single handler per connection, the state needs no lock
+            std::shared_ptr<connection_t> connection = std::make_shared<connection_t>();
+            connection->in.resize(VSOCK_READ_BUFFER_SIZE);
+            connection->used = 0;
+            connection->sent = 0;
+            connection->writing = false;
+            poll_->Add(client_id, EPOLLIN | EPOLLONESHOT, [this, connection](const SocketID socket_id) {
+                Serve_(socket_id, *connection);
+            });
+            if (inline_dispatch_) {
+                poll_->SetInlineDispatch(client_id, true);
+            }
+        }
+        poll_->ResetFlags(listen_id);
+    }
+
+    void BenchServer::Serve_(const SocketID socket_id, connection_t& connection) {
+        bool closed = false;
+        while (true) {
+            if (connection.used == connection.in.size()) {
+                connection.in.resize(connection.in.size() * 2);
+            }
+            const ssize_t received = ::recv(
+                socket_id, connection.in.data() + connection.used, connection.in.size() - connection.used, 0
+            );
+            if (received > 0) {
+                connection.used += static_cast<std::size_t>(received);
+                continue;
+            }
+            closed = received == 0 || !VSOCK_WOULD_BLOCK();
+            break;
+        }
+
+        // Answer every complete frame, the tail waits for the next event
+        std::size_t offset = 0;
+        std::uint64_t answered = 0;
+        while (connection.used - offset >= VSOCK_BENCH_HEADER_SIZE) {
+            const frame_header_t header = DecodeHeader(connection.in.data() + offset);
+            if (connection.used - offset - VSOCK_BENCH_HEADER_SIZE < header.length) {
+                break;
+            }
+            const char* payload = connection.in.data() + offset + VSOCK_BENCH_HEADER_SIZE;
+            const std::size_t at = connection.out.size();
+            connection.out.resize(at + VSOCK_BENCH_HEADER_SIZE + header.reply);
+            EncodeHeader(connection.out.data() + at, { header.reply, header.reply });
+            std::memcpy(
+                connection.out.data() + at + VSOCK_BENCH_HEADER_SIZE, payload, std::min(header.length, header.reply)
+            );
+            offset += VSOCK_BENCH_HEADER_SIZE + header.length;
+            ++answered;
+        }
+        if (offset) {
+            std::memmove(connection.in.data(), connection.in.data() + offset, connection.used - offset);
+            connection.used -= offset;
+        }
+        requests_.fetch_add(answered, std::memory_order_relaxed);
+
+        // Whatever the socket takes now, the rest waits for EPOLLOUT
+        closed = !Flush_(socket_id, connection) || closed;
+
+        if (closed) {
+            poll_->Remove(socket_id);
+            closesocket(socket_id);
+            return;
+        }
+        // Requests are still read while replies wait, a client blocked on its
+        // own writes would otherwise never read them
+        const bool writing = connection.sent < connection.out.size();
+        if (writing != connection.writing) {
+            connection.writing = writing;
+            poll_->Modify(socket_id, writing ? (EPOLLIN | EPOLLOUT | EPOLLONESHOT) : (EPOLLIN | EPOLLONESHOT));
+            return;
+        }
+        poll_->ResetFlags(socket_id);
+    }
+
+    bool BenchServer::Flush_(const SocketID socket_id, connection_t& connection) {
+        while (connection.sent < connection.out.size()) {
+            const ssize_t result = ::send(
+                socket_id, connection.out.data() + connection.sent, connection.out.size() - connection.sent, MSG_NOSIGNAL
+            );
+            if (result > 0) {
+                connection.sent += static_cast<std::size_t>(result);
+                continue;
+            }
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            return result < 0 && VSOCK_WOULD_BLOCK();
+        }
+        connection.out.clear();
+        connection.sent = 0;
+        return true;
+    }
+
+}
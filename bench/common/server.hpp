@@ -0,0 +1,66 @@
+#ifndef INCLUDE_GUARD_VSOCK_BENCH_SERVER_HPP
+#define INCLUDE_GUARD_VSOCK_BENCH_SERVER_HPP
+
+#include <common/bench.hpp>
+#include <pollmanager/manager/poll.hpp>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace vsock::bench {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // BenchServer class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Framed echo and request/response server on a PollManager. Every
+    // connection is registered EPOLLONESHOT, its handler reads what is
+    // available, answers every complete frame and rearms the socket.
+    // Replies the socket does not take at once wait for EPOLLOUT.
+    class BenchServer {
+    public:
+
+        BenchServer() = delete;
+        BenchServer(const BenchServer&) = delete;
+        BenchServer(BenchServer&&) = delete;
+        BenchServer& operator=(const BenchServer&) = delete;
+        BenchServer& operator=(BenchServer&&) = delete;
+
+    private:
+
+        typedef struct {
+            std::vector<char> in;
+            std::size_t used;
+            std::vector<char> out;
+            std::size_t sent;
+            bool writing;
+        } connection_t;
+
+    public:
+
+        BenchServer(PollManager* const poll, const endpoint_t& endpoint, const bool inline_dispatch);
+        ~BenchServer();
+
+        const endpoint_t& Endpoint() const noexcept;
+        std::uint64_t Requests() const noexcept;
+
+    private:
+
+        void Accept_(const SocketID listen_id);
+        void Serve_(const SocketID socket_id, connection_t& connection);
+        bool Flush_(const SocketID socket_id, connection_t& connection);
+
+    private:
+
+        PollManager* const poll_;
+        endpoint_t endpoint_;
+        const bool inline_dispatch_;
+        SocketID listen_id_;
+        std::atomic<std::uint64_t> requests_;
+
+    };
+
+}
+
+#endif // INCLUDE_GUARD_VSOCK_BENCH_SERVER_HPP
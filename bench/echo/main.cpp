@@ -0,0 +1,133 @@
+#include <common/bench.hpp>
+#include <common/server.hpp>
+#include <common/client.hpp>
+#include <core/error.hpp>
+
+#include <cstdio>
+#include <thread>
+
+using namespace vsock;
+using namespace vsock::bench;
+
+namespace {
+
+    const char* usage =
+        "Loopback echo and request/response benchmark of PollManager\n"
+        "  --transport=tcp|unix     listening socket family (tcp,unix runs both)\n"
+        "  --mode=echo|rr           echo the payload or answer with --reply bytes\n"
+        "  --connections=N[,N...]   client connections, one client thread each\n"
+        "  --size=N[,N...]          request payload bytes\n"
+        "  --reply=N                response payload bytes in rr mode\n"
+        "  --depth=N[,N...]         requests in flight per connection\n"
+        "  --threads=N              ThreadPool size, one worker runs the reactor\n"
+        "  --inline                 handle events on the reactor thread\n"
+        "  --duration=S --warmup=S  measured and discarded seconds per run\n"
+        "  --json                   one JSON object per run\n"
+        "  --serve=tcp:PORT|unix:PATH  only run the server, e.g. for bench_loadgen\n";
+
+    typedef struct {
+        Transport transport;
+        bool echo;
+        std::size_t connections;
+        std::size_t size;
+        std::size_t reply;
+        std::size_t depth;
+        std::size_t threads;
+        bool inline_dispatch;
+        double duration;
+        double warmup;
+    } run_t;
+
+    void Run(const run_t& run, const bool json) {
+        ThreadPool pool(run.threads);
+        std::unique_ptr<PollManager> poll = std::make_unique<PollManager>(&pool);
+        std::unique_ptr<BenchServer> server = std::make_unique<BenchServer>(
+            poll.get(), ParseEndpoint(TransportName(run.transport)), run.inline_dispatch
+        );
+
+        const load_result_t total = RunClosedLoop(
+            server->Endpoint(), { run.connections, run.size, run.reply, run.depth, run.warmup, run.duration }
+        );
+        const double elapsed = total.seconds;
+
+        Report(run.echo ? "echo" : "rr")
+            .Add("transport", TransportName(run.transport))
+            .Add("connections", run.connections)
+            .Add("size", run.size)
+            .Add("reply", run.reply)
+            .Add("depth", run.depth)
+            .Add("threads", run.threads)
+            .Add("inline", run.inline_dispatch ? "1"s : "0"s)
+            .Add("seconds", elapsed)
+            .Add("msgs", total.messages)
+            .Add("msgs_per_s", static_cast<double>(total.messages) / elapsed)
+            .Add("bytes_per_s", static_cast<double>(total.bytes) / elapsed)
+            .AddLatency(total.latency)
+            .Print(json);
+
+        // Handlers reference the server, it has to outlive the manager
+        poll->Drain(Clock::now() + std::chrono::seconds(1));
+        poll.reset();
+        server.reset();
+    }
+
+}
+
+int main(int argc, char** argv) {
+    try {
+        const Options options(argc, argv);
+        if (options.Has("help")) {
+            std::printf("%s", usage);
+            return 0;
+        }
+
+        if (options.Has("serve")) {
+            ThreadPool pool(std::max<std::size_t>(options.GetSize("threads", std::thread::hardware_concurrency()), 2));
+            PollManager poll(&pool);
+            BenchServer server(&poll, ParseEndpoint(options.Get("serve", "tcp")), options.Has("inline"));
+            std::printf("listening on %s\n", FormatEndpoint(server.Endpoint()).c_str());
+            std::fflush(stdout);
+            while (true) {
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+            }
+        }
+
+        std::vector<Transport> transports;
+        const std::string transport = options.Get("transport", "tcp");
+        if (transport.find("tcp") != std::string::npos) {
+            transports.push_back(Transport::TCP);
+        }
+        if (transport.find("unix") != std::string::npos) {
+            transports.push_back(Transport::UNIX);
+        }
+        const bool echo = options.Get("mode", "echo") == "echo";
+
+        // Every combination of the list options is a separate run
+        for (const Transport each_transport : transports) {
+            for (const std::size_t connections : options.GetSizes("connections", "1,16")) {
+                for (const std::size_t size : options.GetSizes("size", "64,4096")) {
+                    for (const std::size_t depth : options.GetSizes("depth", "1,16")) {
+                        run_t run;
+                        run.transport = each_transport;
+                        run.echo = echo;
+                        run.connections = connections;
+                        run.size = size;
+                        run.reply = echo ? size : options.GetSize("reply", 64);
+                        run.depth = std::max<std::size_t>(depth, 1);
+                        // The reactor keeps one worker, handlers need at least one more
+                        run.threads = std::max<std::size_t>(options.GetSize("threads", std::thread::hardware_concurrency()), 2);
+                        run.inline_dispatch = options.Has("inline");
+                        run.duration = options.GetDouble("duration", 3.0);
+                        run.warmup = options.GetDouble("warmup", 0.5);
+                        Run(run, options.Has("json"));
+                    }
+                }
+            }
+        }
+    }
+    catch (const std::exception& error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        return 1;
+    }
+    return 0;
+}
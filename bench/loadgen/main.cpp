@@ -0,0 +1,347 @@
+#include <common/bench.hpp>
+#include <common/server.hpp>
+#include <core/error.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+
+using namespace vsock;
+using namespace vsock::bench;
+
+namespace {
+
+    const char* usage =
+        "Load generator speaking the benchmark framing, built on PollManager\n"
+        "  --target=tcp:PORT|unix:PATH  server to load, an in-process one when omitted\n"
+        "  --mode=open|closed           fixed-rate schedule or requests per reply\n"
+        "  --rate=N                     requests per second (open, closed correction)\n"
+        "  --connections=N              non-blocking client connections\n"
+        "  --depth=N                    requests in flight per connection (closed)\n"
+        "  --size=N|MIN-MAX             request payload bytes, uniform in a range\n"
+        "  --reply=N                    response payload bytes, 0 echoes the request\n"
+        "  --threads=N --pacers=N       ThreadPool size, open loop sender tasks\n"
+        "  --duration=S --warmup=S      measured and discarded seconds\n"
+        "  --json                       print the result as a JSON object\n";
+
+    typedef struct {
+        Clock::time_point intended;
+        Clock::time_point sent;
+    } pending_t;
+
+    // Receive state is guarded by mtx. Senders hold send_mtx across the
+    // write and take mtx only to queue the pending entry, so a blocked
+    // sender never stops the handler from draining replies.
+    typedef struct {
+        SocketID socket_id;
+        std::mutex mtx;
+        std::deque<pending_t> pending;
+        std::vector<char> in;
+        std::size_t used;
+        std::mutex send_mtx;
+        std::vector<char> out;
+        std::mt19937_64 random;
+        Histogram response;
+        Histogram service;
+        std::uint64_t messages;
+        std::uint64_t bytes;
+    } connection_t;
+
+    typedef struct {
+        bool open;
+        std::size_t connections;
+        double rate;
+        std::size_t depth;
+        std::size_t size_min;
+        std::size_t size_max;
+        std::size_t reply;
+        std::size_t threads;
+        std::size_t pacers;
+        double duration;
+        double warmup;
+    } config_t;
+
+    class LoadGenerator {
+    public:
+
+        LoadGenerator(const config_t& config, const endpoint_t& target);
+        ~LoadGenerator();
+
+        void Run(const bool json);
+
+    private:
+
+        void Send_(connection_t& connection, const Clock::time_point intended);
+        void Receive_(const SocketID socket_id, connection_t& connection);
+        void Pace_(const std::size_t pacer);
+
+    private:
+
+        const config_t config_;
+        ThreadPool pool_;
+        std::unique_ptr<PollManager> poll_;
+        std::vector<std::unique_ptr<connection_t>> connections_;
+        std::atomic<bool> recording_;
+        std::atomic<bool> stopping_;
+        std::atomic<std::size_t> pacers_running_;
+        Clock::time_point start_;
+        // Closed loop correction, the gap a connection is expected to keep
+        std::uint64_t interval_;
+
+    };
+
+    LoadGenerator::LoadGenerator(const config_t& config, const endpoint_t& target) :
+        config_{ config },
+        pool_{ config.threads },
+        poll_{ std::make_unique<PollManager>(&pool_) },
+        recording_{ false },
+        stopping_{ false },
+        pacers_running_{ 0 },
+        start_{},
+        interval_{ 0 }
+    {
+        if (!config_.open && config_.rate > 0) {
+            interval_ = static_cast<std::uint64_t>(1e9 * config_.connections * config_.depth / config_.rate);
+        }
+        for (std::size_t i = 0; i < config_.connections; ++i) {
+            std::unique_ptr<connection_t> connection = std::make_unique<connection_t>();
+            connection->socket_id = Connect(target, true);
+            connection->in.resize(VSOCK_READ_BUFFER_SIZE);
+            connection->used = 0;
+            connection->random.seed(i + 1);
+            connection->messages = 0;
+            connection->bytes = 0;
+            connection_t* const state = connection.get();
+            poll_->AddFd(
+                connection->socket_id, PollManager::FdType::SOCKET, PollManager::Ownership::BORROWED,
+                EPOLLIN | EPOLLONESHOT, [this, state](const SocketID socket_id) {
+                    Receive_(socket_id, *state);
+                }
+            );
+            connections_.push_back(std::move(connection));
+        }
+    }
+
+    LoadGenerator::~LoadGenerator() {
+        // Handlers reference the connections, stop the manager before closing them
+        poll_->Drain(Clock::now() + std::chrono::seconds(1));
+        poll_.reset();
+        for (const std::unique_ptr<connection_t>& connection : connections_) {
+            closesocket(connection->socket_id);
+        }
+    }
+
+    void LoadGenerator::Run(const bool json) {
+        start_ = Clock::now();
+        if (config_.open) {
+            pacers_running_ = config_.pacers;
+            for (std::size_t pacer = 0; pacer < config_.pacers; ++pacer) {
+                pool_.AddAsyncTask([this, pacer]() {
+                    Pace_(pacer);
+                });
+            }
+        }
+        else {
+            for (const std::unique_ptr<connection_t>& connection : connections_) {
+                for (std::size_t i = 0; i < config_.depth; ++i) {
+                    Send_(*connection, Clock::now());
+                }
+            }
+        }
+
+        std::this_thread::sleep_for(std::chrono::duration<double>(config_.warmup));
+        const Clock::time_point record_start = Clock::now();
+        recording_ = true;
+        std::this_thread::sleep_for(std::chrono::duration<double>(config_.duration));
+        recording_ = false;
+        const double elapsed = std::chrono::duration<double>(Clock::now() - record_start).count();
+        stopping_ = true;
+        while (pacers_running_) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        Histogram response;
+        Histogram service;
+        std::uint64_t messages = 0;
+        std::uint64_t bytes = 0;
+        std::uint64_t outstanding = 0;
+        for (const std::unique_ptr<connection_t>& connection : connections_) {
+            const std::scoped_lock lock(connection->mtx);
+            response.Merge(connection->response);
+            service.Merge(connection->service);
+            messages += connection->messages;
+            bytes += connection->bytes;
+            outstanding += connection->pending.size();
+        }
+
+        Report report("loadgen");
+        report
+            .Add("mode", config_.open ? "open"s : "closed"s)
+            .Add("connections", config_.connections)
+            .Add("rate", config_.rate)
+            .Add("depth", config_.open ? 0 : config_.depth)
+            .Add("size", std::to_string(config_.size_min) + "-"s + std::to_string(config_.size_max))
+            .Add("reply", config_.reply)
+            .Add("seconds", elapsed)
+            .Add("msgs", messages)
+            .Add("msgs_per_s", static_cast<double>(messages) / elapsed)
+            .Add("bytes_per_s", static_cast<double>(bytes) / elapsed)
+            .Add("outstanding", outstanding)
+            .AddLatency(response)
+            .AddLatency(service, "service_")
+            .Print(json);
+    }
+
+    void LoadGenerator::Send_(connection_t& connection, const Clock::time_point intended) {
+        const std::scoped_lock send_lock(connection.send_mtx);
+        const std::size_t size = config_.size_min == config_.size_max ?
+            config_.size_min :
+            std::uniform_int_distribution<std::size_t>(config_.size_min, config_.size_max)(connection.random);
+        const std::size_t reply = config_.reply ? config_.reply : size;
+
+        connection.out.assign(VSOCK_BENCH_HEADER_SIZE + size, 'x');
+        EncodeHeader(connection.out.data(), { static_cast<std::uint32_t>(size), static_cast<std::uint32_t>(reply) });
+        {
+            // Pending order matches the wire order, both are kept under send_mtx
+            const std::scoped_lock lock(connection.mtx);
+            connection.pending.push_back({ intended, Clock::now() });
+            connection.bytes += recording_.load(std::memory_order_relaxed) ? size : 0;
+        }
+        SendAll(connection.socket_id, connection.out.data(), connection.out.size());
+    }
+
+    void LoadGenerator::Receive_(const SocketID socket_id, connection_t& connection) {
+        std::unique_lock lock(connection.mtx);
+        bool closed = false;
+        std::size_t replies = 0;
+        while (true) {
+            if (connection.used == connection.in.size()) {
+                connection.in.resize(connection.in.size() * 2);
+            }
+            const ssize_t received = ::recv(
+                socket_id, connection.in.data() + connection.used, connection.in.size() - connection.used, 0
+            );
+            if (received > 0) {
+                connection.used += static_cast<std::size_t>(received);
+                continue;
+            }
+            closed = received == 0 || !VSOCK_WOULD_BLOCK();
+            break;
+        }
+
+        std::size_t offset = 0;
+        while (connection.used - offset >= VSOCK_BENCH_HEADER_SIZE && !connection.pending.empty()) {
+            const frame_header_t header = DecodeHeader(connection.in.data() + offset);
+            if (connection.used - offset - VSOCK_BENCH_HEADER_SIZE < header.length) {
+                break;
+            }
+            offset += VSOCK_BENCH_HEADER_SIZE + header.length;
+
+            const Clock::time_point now = Clock::now();
+            const pending_t pending = connection.pending.front();
+            connection.pending.pop_front();
+            // Open loop measures from the schedule, so a stalled sender is not hidden
+            if (recording_.load(std::memory_order_relaxed)) {
+                connection.response.RecordCorrected(Nanoseconds(now - pending.intended), interval_);
+                connection.service.Record(Nanoseconds(now - pending.sent));
+                connection.bytes += header.length;
+                ++connection.messages;
+            }
+            ++replies;
+        }
+        if (offset) {
+            std::memmove(connection.in.data(), connection.in.data() + offset, connection.used - offset);
+            connection.used -= offset;
+        }
+        lock.unlock();
+
+        // Closed loop answers every reply with the next request
+        for (std::size_t i = 0; i < replies && !config_.open && !stopping_.load(std::memory_order_relaxed); ++i) {
+            Send_(connection, Clock::now());
+        }
+
+        if (!closed) {
+            poll_->ResetFlags(socket_id);
+        }
+    }
+
+    void LoadGenerator::Pace_(const std::size_t pacer) {
+        // Pacer p owns connections p, p + pacers, ... and a share of the rate
+        const std::size_t owned = (config_.connections - pacer + config_.pacers - 1) / config_.pacers;
+        const double period = 1e9 * static_cast<double>(config_.pacers) / config_.rate;
+        for (std::uint64_t k = 0; owned && !stopping_.load(std::memory_order_relaxed); ++k) {
+            const Clock::time_point intended = start_ + std::chrono::nanoseconds(
+                static_cast<std::int64_t>(period * static_cast<double>(k))
+            );
+            std::this_thread::sleep_until(intended);
+            Send_(*connections_[pacer + (k % owned) * config_.pacers], intended);
+        }
+        --pacers_running_;
+    }
+
+}
+
+int main(int argc, char** argv) {
+    try {
+        const Options options(argc, argv);
+        if (options.Has("help")) {
+            std::printf("%s", usage);
+            return 0;
+        }
+
+        config_t config;
+        config.open = options.Get("mode", "closed") == "open";
+        config.connections = std::max<std::size_t>(options.GetSize("connections", 16), 1);
+        config.rate = options.GetDouble("rate", config.open ? 10000.0 : 0.0);
+        config.depth = std::max<std::size_t>(options.GetSize("depth", 1), 1);
+        const std::string size = options.Get("size", "64");
+        const std::size_t dash = size.find('-');
+        config.size_min = std::stoull(size.substr(0, dash));
+        config.size_max = dash == std::string::npos ? config.size_min : std::stoull(size.substr(dash + 1));
+        config.reply = options.GetSize("reply", 0);
+        config.pacers = std::min(std::max<std::size_t>(options.GetSize("pacers", 1), 1), config.connections);
+        // Reactor, one handler worker and the pacers each need a thread
+        config.threads = std::max(options.GetSize("threads", 4), config.pacers + 2);
+        config.duration = options.GetDouble("duration", 5.0);
+        config.warmup = options.GetDouble("warmup", 1.0);
+        if (config.open && config.rate <= 0) {
+            throw RuntimeError(
+                "Method: main()"s,
+                "Message: open loop needs --rate"s
+            );
+        }
+
+        // Without a target the framed server runs in-process on its own pool
+        std::unique_ptr<ThreadPool> server_pool;
+        std::unique_ptr<PollManager> server_poll;
+        std::unique_ptr<BenchServer> server;
+        endpoint_t target;
+        if (options.Has("target")) {
+            target = ParseEndpoint(options.Get("target", ""));
+        }
+        else {
+            server_pool = std::make_unique<ThreadPool>(std::max<std::size_t>(options.GetSize("server-threads", 4), 2));
+            server_poll = std::make_unique<PollManager>(server_pool.get());
+            server = std::make_unique<BenchServer>(server_poll.get(), ParseEndpoint("tcp"), false);
+            target = server->Endpoint();
+        }
+
+        {
+            LoadGenerator generator(config, target);
+            generator.Run(options.Has("json"));
+        }
+
+        if (server_poll) {
+            server_poll->Drain(Clock::now() + std::chrono::seconds(1));
+            server_poll.reset();
+        }
+    }
+    catch (const std::exception& error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,446 @@
+#include <common/bench.hpp>
+#include <common/server.hpp>
+#include <common/client.hpp>
+#include <core/error.hpp>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <unordered_map>
+
+using namespace vsock;
+using namespace vsock::bench;
+
+namespace {
+
+    const char* usage =
+        "Per-event overhead of PollManager against a raw epoll echo loop\n"
+        "  --transport=tcp|unix      loopback socket family\n"
+        "  --connections=N --depth=N closed loop clients, 1 and 1 time a single event\n"
+        "  --size=N                  echo payload bytes\n"
+        "  --threads=N               ThreadPool size of the PollManager runs\n"
+        "  --metrics                 also report queue delay and handler time\n"
+        "  --fds=N                   registry size of the lookup component\n"
+        "  --ops=N                   iterations per component\n"
+        "  --duration=S --warmup=S   measured and discarded seconds per run\n"
+        "  --json                    one JSON object per result\n";
+
+    // Keeps the compiler from dropping a measured expression
+    template<typename T>
+    inline void Keep(T& value) noexcept {
+        asm volatile("" : : "g"(&value) : "memory");
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // RawServer class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Lower bound: one thread, level-triggered epoll, no registry, no tasks
+    class RawServer {
+    public:
+
+        RawServer(const RawServer&) = delete;
+        RawServer& operator=(const RawServer&) = delete;
+
+    private:
+
+        typedef struct {
+            std::vector<char> in;
+            std::size_t used;
+            std::vector<char> out;
+        } connection_t;
+
+    public:
+
+        explicit RawServer(const endpoint_t& endpoint);
+        ~RawServer();
+
+        const endpoint_t& Endpoint() const noexcept;
+
+    private:
+
+        void Loop_();
+        void Serve_(const SocketID socket_id, connection_t& connection);
+
+    private:
+
+        endpoint_t endpoint_;
+        SocketID listen_id_;
+        int epoll_id_;
+        int stop_id_;
+        std::thread thread_;
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // RawServer class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    RawServer::RawServer(const endpoint_t& endpoint) :
+        endpoint_{ endpoint },
+        listen_id_{ VSOCK_INVALID_SOCKET },
+        epoll_id_{ ::epoll_create1(0) },
+        stop_id_{ ::eventfd(0, EFD_NONBLOCK) }
+    {
+        listen_id_ = Listen(endpoint_, 4096);
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = listen_id_;
+        ::epoll_ctl(epoll_id_, EPOLL_CTL_ADD, listen_id_, &ev);
+        ev.data.fd = stop_id_;
+        ::epoll_ctl(epoll_id_, EPOLL_CTL_ADD, stop_id_, &ev);
+        thread_ = std::thread(&RawServer::Loop_, this);
+    }
+
+    RawServer::~RawServer() {
+        const std::uint64_t one = 1;
+        [[maybe_unused]] const ssize_t written = ::write(stop_id_, &one, sizeof(one));
+        thread_.join();
+        closesocket(listen_id_);
+        ::close(stop_id_);
+        ::close(epoll_id_);
+        if (endpoint_.transport == Transport::UNIX) {
+            ::unlink(endpoint_.path.c_str());
+        }
+    }
+
+    const endpoint_t& RawServer::Endpoint() const noexcept {
+        return endpoint_;
+    }
+
+    void RawServer::Loop_() {
+        std::unordered_map<SocketID, connection_t> connections;
+        struct epoll_event events[64];
+        while (true) {
+            const int nfds = ::epoll_wait(epoll_id_, events, 64, -1);
+            for (int i = 0; i < nfds; ++i) {
+                const SocketID socket_id = events[i].data.fd;
+                if (socket_id == stop_id_) {
+                    for (auto& [client_id, connection] : connections) {
+                        closesocket(client_id);
+                    }
+                    return;
+                }
+                if (socket_id == listen_id_) {
+                    SocketID client_id;
+                    while ((client_id = ::accept(listen_id_, nullptr, nullptr)) != VSOCK_INVALID_SOCKET) {
+                        SetNonBlocking(client_id);
+                        connections[client_id] = { std::vector<char>(VSOCK_READ_BUFFER_SIZE), 0, {} };
+                        struct epoll_event ev;
+                        ev.events = EPOLLIN;
+                        ev.data.fd = client_id;
+                        ::epoll_ctl(epoll_id_, EPOLL_CTL_ADD, client_id, &ev);
+                    }
+                    continue;
+                }
+                auto it = connections.find(socket_id);
+                if (it != connections.end()) {
+                    Serve_(socket_id, it->second);
+                    if (it->second.used == static_cast<std::size_t>(-1)) {
+                        ::epoll_ctl(epoll_id_, EPOLL_CTL_DEL, socket_id, nullptr);
+                        closesocket(socket_id);
+                        connections.erase(it);
+                    }
+                }
+            }
+        }
+    }
+
+    void RawServer::Serve_(const SocketID socket_id, connection_t& connection) {
+        while (true) {
+            if (connection.used == connection.in.size()) {
+                connection.in.resize(connection.in.size() * 2);
+            }
+            const ssize_t received = ::recv(
+                socket_id, connection.in.data() + connection.used, connection.in.size() - connection.used, 0
+            );
+            if (received > 0) {
+                connection.used += static_cast<std::size_t>(received);
+                continue;
+            }
+            if (received == 0 || !VSOCK_WOULD_BLOCK()) {
+                // Marks the connection for removal by the loop
+                connection.used = static_cast<std::size_t>(-1);
+                return;
+            }
+            break;
+        }
+
+        std::size_t offset = 0;
+        while (connection.used - offset >= VSOCK_BENCH_HEADER_SIZE) {
+            const frame_header_t header = DecodeHeader(connection.in.data() + offset);
+            if (connection.used - offset - VSOCK_BENCH_HEADER_SIZE < header.length) {
+                break;
+            }
+            const std::size_t at = connection.out.size();
+            connection.out.resize(at + VSOCK_BENCH_HEADER_SIZE + header.reply);
+            EncodeHeader(connection.out.data() + at, { header.reply, header.reply });
+            std::memcpy(
+                connection.out.data() + at + VSOCK_BENCH_HEADER_SIZE,
+                connection.in.data() + offset + VSOCK_BENCH_HEADER_SIZE,
+                std::min(header.length, header.reply)
+            );
+            offset += VSOCK_BENCH_HEADER_SIZE + header.length;
+        }
+        if (offset) {
+            std::memmove(connection.in.data(), connection.in.data() + offset, connection.used - offset);
+            connection.used -= offset;
+        }
+        if (!connection.out.empty()) {
+            SendAll(socket_id, connection.out.data(), connection.out.size());
+            connection.out.clear();
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Helpers
+    //////////////////////////////////////////////////////////////////////////////////
+
+    typedef struct {
+        Transport transport;
+        load_t load;
+        std::size_t threads;
+        bool metrics;
+        bool json;
+    } config_t;
+
+    double MetricsMean(const Metrics::snapshot_t& snapshot, const Metrics::Histogram histogram) {
+        const std::uint64_t count = Metrics::Count(snapshot, histogram);
+        return count ? static_cast<double>(snapshot.sums[static_cast<std::size_t>(histogram)]) / count : 0.0;
+    }
+
+    Report EndToEnd(const char* mode, const config_t& config, const load_result_t& result, const double baseline) {
+        Report report("overhead");
+        report
+            .Add("mode", mode)
+            .Add("transport", TransportName(config.transport))
+            .Add("connections", config.load.connections)
+            .Add("depth", config.load.depth)
+            .Add("size", config.load.size)
+            .Add("msgs_per_s", static_cast<double>(result.messages) / result.seconds)
+            .Add("mean_us", result.latency.Mean() / 1000.0)
+            .AddLatency(result.latency)
+            .Add("added_ns", baseline > 0 ? result.latency.Mean() - baseline : 0.0);
+        return report;
+    }
+
+    double RunRaw(const config_t& config) {
+        RawServer server(ParseEndpoint(TransportName(config.transport)));
+        const load_result_t result = RunClosedLoop(server.Endpoint(), config.load);
+        EndToEnd("raw_epoll", config, result, 0.0).Print(config.json);
+        return result.latency.Mean();
+    }
+
+    void RunPoll(const config_t& config, const bool inline_dispatch, const double baseline) {
+        ThreadPool pool(config.threads);
+        std::unique_ptr<PollManager> poll = std::make_unique<PollManager>(&pool);
+        poll->Stats().SetEnabled(config.metrics);
+        std::unique_ptr<BenchServer> server = std::make_unique<BenchServer>(
+            poll.get(), ParseEndpoint(TransportName(config.transport)), inline_dispatch
+        );
+        const Metrics::snapshot_t before = poll->Stats().Snapshot();
+        const load_result_t result = RunClosedLoop(server->Endpoint(), config.load);
+        const Metrics::snapshot_t after = poll->Stats().Snapshot();
+
+        Report report = EndToEnd(inline_dispatch ? "poll_inline" : "poll_pool", config, result, baseline);
+        report.Add("threads", config.threads);
+        if (config.metrics) {
+            // Warmup samples are included, the means are still dominated by the measured run
+            const auto counter = [&before, &after](const Metrics::Counter counter) {
+                const std::size_t index = static_cast<std::size_t>(counter);
+                return static_cast<double>(after.counters[index] - before.counters[index]);
+            };
+            const double waits = counter(Metrics::Counter::EPOLL_WAITS);
+            report
+                .Add("events_per_wait", waits > 0 ? counter(Metrics::Counter::EVENTS) / waits : 0.0)
+                .Add("ctls_per_msg", result.messages ? counter(Metrics::Counter::EPOLL_CTLS) / result.messages : 0.0);
+        }
+        if (config.metrics && !inline_dispatch) {
+            // Only pooled handlers are timed, inline ones never become tasks
+            report
+                .Add("queue_delay_ns", MetricsMean(after, Metrics::Histogram::QUEUE_DELAY))
+                .Add("handler_ns", MetricsMean(after, Metrics::Histogram::HANDLER_TIME));
+        }
+        report.Print(config.json);
+
+        // Handlers reference the server, it has to outlive the manager
+        poll->Drain(Clock::now() + std::chrono::seconds(1));
+        poll.reset();
+        server.reset();
+    }
+
+    template<typename F>
+    void Component(const char* name, const char* step, const std::size_t ops, const bool json, F&& body) {
+        const Clock::time_point start = Clock::now();
+        for (std::size_t i = 0; i < ops; ++i) {
+            body(i);
+        }
+        const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        Report("overhead_component")
+            .Add("component", name)
+            .Add("step", step)
+            .Add("ops", ops)
+            .Add("ns_per_op", elapsed * 1e9 / static_cast<double>(ops))
+            .Print(json);
+    }
+
+    // The steps PollManager adds to every event, each timed on its own
+    // through the real PollManager, Task and ThreadPool code
+    void RunComponents(const std::size_t fds, const std::size_t ops, const bool json) {
+        typedef std::function<void(const SocketID)> callback_func_t;
+
+        ThreadPool pool(2);
+        std::unique_ptr<PollManager> poll = std::make_unique<PollManager>(&pool);
+
+        // Event fds are cheap to register, the manager owns and closes them
+        std::atomic<std::uint64_t> dispatched{ 0 };
+        std::vector<SocketID> ids;
+        ids.reserve(fds);
+        for (std::size_t n = 0; n < fds; ++n) {
+            const SocketID event_id = ::eventfd(0, EFD_NONBLOCK);
+            if (event_id == VSOCK_INVALID_SOCKET) {
+                break;
+            }
+            poll->AddFd(event_id, PollManager::FdType::EVENT, PollManager::Ownership::OWNED, EPOLLIN,
+                [&dispatched](const SocketID socket_id) {
+                    std::uint64_t value = 0;
+                    if (::read(socket_id, &value, sizeof(value)) == sizeof(value)) {
+                        dispatched.fetch_add(1, std::memory_order_release);
+                    }
+                });
+            ids.push_back(event_id);
+        }
+        if (ids.empty()) {
+            throw RuntimeError(
+                "Method: RunComponents()"s,
+                "Message: ::eventfd() failed"s
+            );
+        }
+
+        // Same lock and hash lookup every routed event pays
+        Component("registry_lookup", "Route_:locked_find", ops, json, [&](const std::size_t i) {
+            poll->SetInlineDispatch(ids[i % ids.size()], true);
+        });
+
+        // Reactor reads the event and runs the handler in place, no task
+        const std::size_t rounds = std::max<std::size_t>(ops / 100, 1);
+        Component("inline_dispatch", "Poll_/Route_:inline_handler", rounds, json, [&](const std::size_t i) {
+            const std::uint64_t one = 1;
+            const std::uint64_t before = dispatched.load(std::memory_order_acquire);
+            if (::write(ids[i % ids.size()], &one, sizeof(one)) != sizeof(one)) {
+                return;
+            }
+            while (dispatched.load(std::memory_order_acquire) == before) {
+                std::this_thread::yield();
+            }
+        });
+
+        poll->Drain(Clock::now() + std::chrono::seconds(1));
+        poll.reset();
+
+        std::uint64_t sink = 0;
+        const callback_func_t callback = [&sink](const SocketID socket_id) {
+            sink += static_cast<std::uint64_t>(socket_id);
+        };
+        Component("function_copy", "Route_:callback_copy", ops, json, [&](const std::size_t) {
+            callback_func_t copy = callback;
+            Keep(copy);
+        });
+
+        Component("task_allocation", "Enqueue_:make_task", ops, json, [&](const std::size_t i) {
+            std::unique_ptr<Task> task = std::make_unique<Task>();
+            task->SetAsyncJob([&callback, i]() {
+                callback(static_cast<SocketID>(i));
+            });
+            Keep(task);
+        });
+
+        // Paused, the workers leave the queue alone and only the push is timed.
+        // Continue() then drains it, Wait() returns once every task ran.
+        const std::size_t batch = std::min<std::size_t>(ops, 65536);
+        double push_seconds = 0.0;
+        double drain_seconds = 0.0;
+        std::size_t queued = 0;
+        while (queued < ops) {
+            const std::size_t count = std::min(batch, ops - queued);
+            std::vector<std::unique_ptr<Task>> tasks(count);
+            for (std::size_t n = 0; n < count; ++n) {
+                tasks[n] = std::make_unique<Task>();
+                tasks[n]->SetAsyncJob([&callback, n]() {
+                    callback(static_cast<SocketID>(n));
+                });
+            }
+            pool.Pause();
+            const Clock::time_point push_start = Clock::now();
+            for (std::size_t n = 0; n < count; ++n) {
+                pool.AddAffineTask(n % 2, ThreadPool::Priority::NORMAL, std::move(tasks[n]));
+            }
+            const Clock::time_point drain_start = Clock::now();
+            pool.Continue();
+            pool.Wait();
+            push_seconds += std::chrono::duration<double>(drain_start - push_start).count();
+            drain_seconds += std::chrono::duration<double>(Clock::now() - drain_start).count();
+            queued += count;
+        }
+        Report("overhead_component")
+            .Add("component", "queue_push")
+            .Add("step", "Push_:locked_queue")
+            .Add("ops", ops)
+            .Add("ns_per_op", push_seconds * 1e9 / static_cast<double>(ops))
+            .Print(json);
+        Report("overhead_component")
+            .Add("component", "queue_drain")
+            .Add("step", "Process_:pop_and_run")
+            .Add("ops", ops)
+            .Add("ns_per_op", drain_seconds * 1e9 / static_cast<double>(ops))
+            .Print(json);
+
+        // One task to an idle pool: push, wake a sleeping worker, run, report back
+        Component("wakeup", "Push_:notify_idle_worker", rounds, json, [&](const std::size_t) {
+            pool.AddAsyncTask([&callback]() {
+                callback(0);
+            });
+            pool.Wait();
+        });
+        Keep(sink);
+    }
+
+}
+
+int main(int argc, char** argv) {
+    try {
+        const Options options(argc, argv);
+        if (options.Has("help")) {
+            std::printf("%s", usage);
+            return 0;
+        }
+
+        config_t config;
+        config.transport = ParseEndpoint(options.Get("transport", "tcp")).transport;
+        config.load.connections = std::max<std::size_t>(options.GetSize("connections", 1), 1);
+        config.load.size = options.GetSize("size", 64);
+        config.load.reply = config.load.size;
+        config.load.depth = std::max<std::size_t>(options.GetSize("depth", 1), 1);
+        config.load.warmup = options.GetDouble("warmup", 0.5);
+        config.load.duration = options.GetDouble("duration", 3.0);
+        config.threads = std::max<std::size_t>(options.GetSize("threads", 4), 2);
+        config.metrics = options.Has("metrics");
+        config.json = options.Has("json");
+
+        const double baseline = RunRaw(config);
+        RunPoll(config, true, baseline);
+        RunPoll(config, false, baseline);
+        RunComponents(
+            std::max<std::size_t>(options.GetSize("fds", 1024), 1),
+            std::max<std::size_t>(options.GetSize("ops", 1000000), 1),
+            config.json
+        );
+    }
+    catch (const std::exception& error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,233 @@
+#include <common/bench.hpp>
+#include <threadpool/threadpool.hpp>
+#include <core/error.hpp>
+
+#include <cstdio>
+#include <thread>
+
+using namespace vsock;
+using namespace vsock::bench;
+
+namespace {
+
+    const char* usage =
+        "ThreadPool microbenchmarks, one result line per case and thread count\n"
+        "  --threads=N[,N...]   pool sizes to measure\n"
+        "  --cases=LIST         submit,producers,sync,wakeup,wait,loop (default all)\n"
+        "  --tasks=N            tasks per throughput case\n"
+        "  --producers=N        producer threads of the producers case, 0 = pool size\n"
+        "  --iterations=N       samples per latency case\n"
+        "  --idle-us=N          pause before each wakeup sample\n"
+        "  --json               one JSON object per result\n";
+
+    typedef struct {
+        std::size_t threads;
+        std::size_t tasks;
+        std::size_t producers;
+        std::size_t iterations;
+        std::size_t idle_us;
+        bool json;
+    } config_t;
+
+    double Seconds(const Clock::time_point start) noexcept {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    void WaitFor(const std::atomic<std::size_t>& counter, const std::size_t value) noexcept {
+        while (counter.load(std::memory_order_acquire) < value) {
+            std::this_thread::yield();
+        }
+    }
+
+    void Throughput(const config_t& config, const char* name, const std::size_t producers, const double elapsed) {
+        Report(name)
+            .Add("threads", config.threads)
+            .Add("producers", producers)
+            .Add("tasks", config.tasks)
+            .Add("seconds", elapsed)
+            .Add("tasks_per_s", static_cast<double>(config.tasks) / elapsed)
+            .Add("ns_per_task", elapsed * 1e9 / static_cast<double>(config.tasks))
+            .Print(config.json);
+    }
+
+    void Latency(const config_t& config, const char* name, const Histogram& histogram) {
+        Report(name)
+            .Add("threads", config.threads)
+            .Add("iterations", histogram.Count())
+            .Add("mean_us", histogram.Mean() / 1000.0)
+            .AddLatency(histogram)
+            .Print(config.json);
+    }
+
+    // Single producer: AddAsyncTask cost plus draining until the last task ran
+    void Submit(const config_t& config) {
+        ThreadPool pool(config.threads);
+        std::atomic<std::size_t> done{ 0 };
+        const Clock::time_point start = Clock::now();
+        for (std::size_t i = 0; i < config.tasks; ++i) {
+            pool.AddAsyncTask([&done]() {
+                done.fetch_add(1, std::memory_order_release);
+            });
+        }
+        WaitFor(done, config.tasks);
+        Throughput(config, "tp_submit", 1, Seconds(start));
+    }
+
+    // Many producers contending on the shared queue lock
+    void Producers(const config_t& config) {
+        ThreadPool pool(config.threads);
+        const std::size_t producers = config.producers ? config.producers : config.threads;
+        const std::size_t share = config.tasks / producers;
+        std::atomic<std::size_t> done{ 0 };
+        std::atomic<bool> go{ false };
+        std::vector<std::thread> threads;
+        for (std::size_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&pool, &done, &go, share]() {
+                while (!go.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                for (std::size_t i = 0; i < share; ++i) {
+                    pool.AddAsyncTask([&done]() {
+                        done.fetch_add(1, std::memory_order_release);
+                    });
+                }
+            });
+        }
+        const Clock::time_point start = Clock::now();
+        go = true;
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        WaitFor(done, share * producers);
+        config_t reported = config;
+        reported.tasks = share * producers;
+        Throughput(reported, "tp_producers", producers, Seconds(start));
+    }
+
+    // AddSyncTask() and future::get() back to back on a busy-free pool
+    void Sync(const config_t& config) {
+        ThreadPool pool(config.threads);
+        Histogram histogram;
+        for (std::size_t i = 0; i < config.iterations; ++i) {
+            const Clock::time_point start = Clock::now();
+            pool.AddSyncTask([]() {
+                return 0;
+            }).get();
+            histogram.Record(Nanoseconds(Clock::now() - start));
+        }
+        Latency(config, "tp_sync_rtt", histogram);
+    }
+
+    // Ping-pong from an idle pool: submit to task start, workers sleep on the cv
+    void Wakeup(const config_t& config) {
+        ThreadPool pool(config.threads);
+        Histogram histogram;
+        for (std::size_t i = 0; i < config.iterations; ++i) {
+            std::this_thread::sleep_for(std::chrono::microseconds(config.idle_us));
+            std::atomic<std::size_t> done{ 0 };
+            Clock::time_point started;
+            const Clock::time_point start = Clock::now();
+            pool.AddAsyncTask([&done, &started]() {
+                started = Clock::now();
+                done.store(1, std::memory_order_release);
+            });
+            WaitFor(done, 1);
+            histogram.Record(Nanoseconds(started - start));
+        }
+        Latency(config, "tp_wakeup", histogram);
+    }
+
+    // Wait() on an empty pool, then after a burst of one task per worker
+    void Wait(const config_t& config) {
+        ThreadPool pool(config.threads);
+        Histogram empty;
+        Histogram burst;
+        for (std::size_t i = 0; i < config.iterations; ++i) {
+            Clock::time_point start = Clock::now();
+            pool.Wait();
+            empty.Record(Nanoseconds(Clock::now() - start));
+
+            start = Clock::now();
+            for (std::size_t t = 0; t < config.threads; ++t) {
+                pool.AddAsyncTask([]() {});
+            }
+            pool.Wait();
+            burst.Record(Nanoseconds(Clock::now() - start));
+        }
+        Latency(config, "tp_wait_empty", empty);
+        Latency(config, "tp_wait_burst", burst);
+    }
+
+    // One LOOP task iterated tasks times: condition, job and requeue per round
+    void Loop(const config_t& config) {
+        ThreadPool pool(config.threads);
+        std::size_t rounds = 0;
+        std::atomic<std::size_t> done{ 0 };
+        const std::size_t total = config.tasks;
+        std::unique_ptr<Task> task = std::make_unique<Task>();
+        task->SetLoopJob([&rounds]() {
+            ++rounds;
+        });
+        task->SetCondition([&rounds, &done, total]() {
+            if (rounds < total) {
+                return true;
+            }
+            done.store(1, std::memory_order_release);
+            return false;
+        });
+        const Clock::time_point start = Clock::now();
+        pool.AddAsyncTask(std::move(task));
+        WaitFor(done, 1);
+        Throughput(config, "tp_loop", 1, Seconds(start));
+    }
+
+}
+
+int main(int argc, char** argv) {
+    try {
+        const Options options(argc, argv);
+        if (options.Has("help")) {
+            std::printf("%s", usage);
+            return 0;
+        }
+
+        const std::string cases = options.Get("cases", "submit,producers,sync,wakeup,wait,loop");
+        auto enabled = [&cases](const std::string& name) {
+            return ("," + cases + ",").find("," + name + ",") != std::string::npos;
+        };
+
+        for (const std::size_t threads : options.GetSizes("threads", "1,2,4,8")) {
+            config_t config;
+            config.threads = std::max<std::size_t>(threads, 1);
+            config.tasks = std::max<std::size_t>(options.GetSize("tasks", 200000), 1);
+            config.producers = options.GetSize("producers", 0);
+            config.iterations = std::max<std::size_t>(options.GetSize("iterations", 10000), 1);
+            config.idle_us = options.GetSize("idle-us", 200);
+            config.json = options.Has("json");
+
+            if (enabled("submit")) {
+                Submit(config);
+            }
+            if (enabled("producers")) {
+                Producers(config);
+            }
+            if (enabled("sync")) {
+                Sync(config);
+            }
+            if (enabled("wakeup")) {
+                Wakeup(config);
+            }
+            if (enabled("wait")) {
+                Wait(config);
+            }
+            if (enabled("loop")) {
+                Loop(config);
+            }
+        }
+    }
+    catch (const std::exception& error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        return 1;
+    }
+    return 0;
+}
@@ -19,10 +19,13 @@
 #ifdef _WIN32
 #define VSOCK_INVALID_SOCKET INVALID_SOCKET
 #define VSOCK_SOCKET_ERROR SOCKET_ERROR
+#define VSOCK_WOULD_BLOCK() (WSAGetLastError() == WSAEWOULDBLOCK)
 using SocketID = SOCKET;
 #else
 #define VSOCK_INVALID_SOCKET -1
 #define VSOCK_SOCKET_ERROR -1
+#define VSOCK_WOULD_BLOCK() (errno == EAGAIN || errno == EWOULDBLOCK)
+#define closesocket(socket_id) ::close(socket_id)
 using SocketID = int;
 #endif
 
@@ -47,4 +50,5 @@ using EpollID = int;
 
 #define VSOCK_EPOLL_TIMEOUT -1
 #define VSOCK_EPOLL_MAX_EVENTS 5
+#define VSOCK_READ_BUFFER_SIZE 16384
 
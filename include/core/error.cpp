@@ -6,7 +6,7 @@ namespace vsock {
     // Helpers
     //////////////////////////////////
 
-    int GetLastErrorCode(bool socket_error) {
+    int GetLastErrorCode([[maybe_unused]] bool socket_error) {
         #ifdef _WIN32
         int res = GetLastError();
         #else
@@ -0,0 +1,16 @@
+#include <core/shards.hpp>
+
+#include <atomic>
+
+namespace vsock {
+
+    ////////////////////////////////////
+    // Helpers
+    //////////////////////////////////
+
+    std::uint64_t NextShardRegistryId() noexcept {
+        static std::atomic<std::uint64_t> counter{ 0 };
+        return ++counter;
+    }
+
+}
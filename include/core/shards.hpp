@@ -0,0 +1,180 @@
+#ifndef INCLUDE_GUARD_VSOCK_CORE_SHARDS_HPP
+#define INCLUDE_GUARD_VSOCK_CORE_SHARDS_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace vsock {
+
+    ////////////////////////////////////
+    // Helpers
+    //////////////////////////////////
+
+    // Registry ids are never reused, a stale thread entry never matches again
+    std::uint64_t NextShardRegistryId() noexcept;
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // ShardRegistry class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // One Shard per registry and thread, found without a lock on the hot path.
+    // An exiting thread hands its shards back and the next new thread adopts
+    // them, so the shard count follows the peak thread count, not thread churn.
+    template<typename Shard>
+    class ShardRegistry {
+    public:
+
+        ShardRegistry() = delete;
+        ShardRegistry(const ShardRegistry&) = delete;
+        ShardRegistry(ShardRegistry&&) = delete;
+        ShardRegistry& operator=(const ShardRegistry&) = delete;
+        ShardRegistry& operator=(ShardRegistry&&) = delete;
+
+    public:
+
+        typedef std::function<void(Shard&)> shard_func_t;
+
+        // init runs when a shard is created, reclaim when its thread exits
+        ShardRegistry(shard_func_t&& init, shard_func_t&& reclaim);
+        ~ShardRegistry();
+
+        Shard* Find() const noexcept;
+        Shard* Local();
+
+        template<typename F>
+        void ForEach(F&& visit);
+
+    private:
+
+        typedef struct {
+            std::mutex mtx;
+            bool closed;
+            std::vector<std::unique_ptr<Shard>> shards;
+            std::vector<Shard*> free;
+            shard_func_t init;
+            shard_func_t reclaim;
+        } state_t;
+
+        typedef struct {
+            std::uint64_t id;
+            Shard* shard;
+            std::weak_ptr<state_t> state;
+        } entry_t;
+
+        // Shards of one thread, handed back when the thread exits
+        class Entries : public std::vector<entry_t> {
+        public:
+            ~Entries();
+        };
+
+        static Entries& Entries_() noexcept;
+
+    private:
+
+        const std::uint64_t id_;
+        std::shared_ptr<state_t> state_;
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // ShardRegistry class defenition (template methods)
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename Shard>
+    ShardRegistry<Shard>::ShardRegistry(shard_func_t&& init, shard_func_t&& reclaim) :
+        id_{ NextShardRegistryId() },
+        state_{ std::make_shared<state_t>() }
+    {
+        state_->closed = false;
+        state_->init = std::move(init);
+        state_->reclaim = std::move(reclaim);
+    }
+
+    template<typename Shard>
+    ShardRegistry<Shard>::~ShardRegistry() {
+        // Threads exiting from now on leave the shards alone
+        const std::scoped_lock state_lock(state_->mtx);
+        state_->closed = true;
+    }
+
+    template<typename Shard>
+    Shard* ShardRegistry<Shard>::Find() const noexcept {
+        for (const entry_t& entry : Entries_()) {
+            if (entry.id == id_) {
+                return entry.shard;
+            }
+        }
+        return nullptr;
+    }
+
+    template<typename Shard>
+    Shard* ShardRegistry<Shard>::Local() {
+        Shard* shard = Find();
+        if (shard) {
+            return shard;
+        }
+
+        // Entries of destroyed registries are dropped on the slow path
+        Entries& entries = Entries_();
+        std::erase_if(entries, [](const entry_t& entry) {
+            return entry.state.expired();
+        });
+        entries.reserve(entries.size() + 1);
+        {
+            const std::scoped_lock state_lock(state_->mtx);
+            if (state_->free.empty()) {
+                state_->shards.push_back(std::make_unique<Shard>());
+                shard = state_->shards.back().get();
+                if (state_->init) {
+                    state_->init(*shard);
+                }
+            }
+            else {
+                shard = state_->free.back();
+                state_->free.pop_back();
+            }
+        }
+        entries.push_back({ id_, shard, state_ });
+        return shard;
+    }
+
+    template<typename Shard>
+    template<typename F>
+    void ShardRegistry<Shard>::ForEach(F&& visit) {
+        const std::scoped_lock state_lock(state_->mtx);
+        for (const std::unique_ptr<Shard>& shard : state_->shards) {
+            visit(*shard);
+        }
+    }
+
+    template<typename Shard>
+    ShardRegistry<Shard>::Entries::~Entries() {
+        for (entry_t& entry : *this) {
+            const std::shared_ptr<state_t> state = entry.state.lock();
+            if (!state) {
+                continue;
+            }
+            const std::scoped_lock state_lock(state->mtx);
+            if (state->closed) {
+                continue;
+            }
+            if (state->reclaim) {
+                state->reclaim(*entry.shard);
+            }
+            state->free.push_back(entry.shard);
+        }
+    }
+
+    template<typename Shard>
+    typename ShardRegistry<Shard>::Entries& ShardRegistry<Shard>::Entries_() noexcept {
+        static thread_local Entries entries;
+        return entries;
+    }
+
+}
+
+#endif // INCLUDE_GUARD_VSOCK_CORE_SHARDS_HPP
@@ -0,0 +1,15 @@
+#include <core/trace.hpp>
+
+namespace vsock {
+
+    ////////////////////////////////////
+    // Helpers
+    //////////////////////////////////
+
+    std::atomic<trace_hook_t> trace_hook{ nullptr };
+
+    void SetTraceHook(const trace_hook_t hook) noexcept {
+        trace_hook.store(hook, std::memory_order_relaxed);
+    }
+
+}
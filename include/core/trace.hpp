@@ -0,0 +1,49 @@
+#ifndef INCLUDE_GUARD_VSOCK_CORE_TRACE_HPP
+#define INCLUDE_GUARD_VSOCK_CORE_TRACE_HPP
+
+#include <atomic>
+#include <cstdint>
+
+// Static tracepoints on the dispatch path, enabled with -DVSOCK_TRACEPOINTS=ON.
+// With <sys/sdt.h> they are USDT probes of provider "vsock" (bpftrace,
+// perf probe sdt_vsock:*), otherwise they call the hook set by SetTraceHook().
+// Compiled out, the macro expands to nothing and its arguments are not evaluated.
+
+namespace vsock {
+
+    ////////////////////////////////////
+    // Helpers
+    //////////////////////////////////
+
+    typedef void (*trace_hook_t)(const char* probe, const std::uint64_t arg0, const std::uint64_t arg1);
+
+    extern std::atomic<trace_hook_t> trace_hook;
+
+    void SetTraceHook(const trace_hook_t hook) noexcept;
+
+}
+
+#if defined(VSOCK_TRACEPOINTS) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define VSOCK_TRACE_SDT
+#endif
+#endif
+
+#if !defined(VSOCK_TRACEPOINTS)
+#define VSOCK_TRACE(name, arg0, arg1) ((void)0)
+#elif defined(VSOCK_TRACE_SDT)
+#define VSOCK_TRACE(name, arg0, arg1) DTRACE_PROBE2(vsock, name, (arg0), (arg1))
+#else
+#define VSOCK_TRACE(name, arg0, arg1)                                                   \
+    do {                                                                                \
+        const vsock::trace_hook_t vsock_trace_hook =                                    \
+            vsock::trace_hook.load(std::memory_order_relaxed);                          \
+        if (vsock_trace_hook) {                                                         \
+            vsock_trace_hook(#name, static_cast<std::uint64_t>(arg0),                   \
+                static_cast<std::uint64_t>(arg1));                                      \
+        }                                                                               \
+    } while (0)
+#endif
+
+#endif // INCLUDE_GUARD_VSOCK_CORE_TRACE_HPP
@@ -0,0 +1,239 @@
+#include <pollmanager/buffer/bufferpool.hpp>
+
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+namespace vsock {
+
+    namespace {
+
+        constexpr std::size_t BLOCK_ALIGN = alignof(BufferBlock);
+        constexpr std::size_t DEFAULT_CACHE_LIMIT = 64;
+
+        inline char* BlockData(BufferBlock* block) noexcept {
+            return reinterpret_cast<char*>(block + 1);
+        }
+
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // IOBuffer class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    IOBuffer::IOBuffer() noexcept :
+        block_{ nullptr },
+        size_{ 0 }
+    {}
+
+    IOBuffer::IOBuffer(BufferBlock* block) noexcept :
+        block_{ block },
+        size_{ 0 }
+    {}
+
+    IOBuffer::IOBuffer(IOBuffer&& other) noexcept :
+        block_{ std::exchange(other.block_,nullptr) },
+        size_{ std::exchange(other.size_,0) }
+    {}
+
+    IOBuffer& IOBuffer::operator=(IOBuffer&& other) noexcept {
+        if (this != &other) {
+            Release();
+            block_ = std::exchange(other.block_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    IOBuffer::~IOBuffer() {
+        Release();
+    }
+
+    char* IOBuffer::Data() noexcept {
+        return block_ ? BlockData(block_) : nullptr;
+    }
+
+    const char* IOBuffer::Data() const noexcept {
+        return block_ ? BlockData(block_) : nullptr;
+    }
+
+    std::size_t IOBuffer::Size() const noexcept {
+        return size_;
+    }
+
+    std::size_t IOBuffer::Capacity() const noexcept {
+        return block_ ? block_->capacity : 0;
+    }
+
+    bool IOBuffer::Empty() const noexcept {
+        return size_ == 0;
+    }
+
+    void IOBuffer::Resize(const std::size_t size) {
+        if (size > Capacity()) {
+            throw std::length_error("IOBuffer::Resize(): size exceeds capacity");
+        }
+        size_ = size;
+    }
+
+    void IOBuffer::Release() noexcept {
+        if (!block_) {
+            return;
+        }
+        if (block_->owner) {
+            block_->owner->pool->Release_(block_);
+        }
+        else {
+            BufferPool::FreeBlock_(block_);
+        }
+        block_ = nullptr;
+        size_ = 0;
+    }
+
+    IOBuffer::operator bool() const noexcept {
+        return block_ != nullptr;
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // BufferPool class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    BufferPool::BufferPool(const std::size_t cache_limit) :
+        cache_limit_{ cache_limit },
+        blocks_allocated_{ 0 },
+        shards_{
+            [this](BufferShard& shard) { shard.pool = this; },
+            // Nobody else touches the local lists of an exited thread
+            [](BufferShard& shard) { FreeLocal_(shard); }
+        }
+    {}
+
+    BufferPool::BufferPool() :
+        BufferPool(DEFAULT_CACHE_LIMIT)
+    {}
+
+    BufferPool::~BufferPool() {
+        shards_.ForEach([](BufferShard& shard) {
+            FreeLocal_(shard);
+            for (std::size_t cls = 0; cls < CLASSES_COUNT; ++cls) {
+                BufferBlock* block = shard.remote[cls].exchange(nullptr, std::memory_order_acquire);
+                while (block) {
+                    FreeBlock_(std::exchange(block, block->next));
+                }
+                shard.remote_count[cls].store(0, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    BufferPool& BufferPool::Default() {
+        static BufferPool pool;
+        return pool;
+    }
+
+    IOBuffer BufferPool::Acquire(const std::size_t size) {
+        const std::size_t cls = ClassFor_(size);
+        if (cls == CLASSES_COUNT) {
+            return IOBuffer(NewBlock_(nullptr, cls, size));
+        }
+
+        BufferShard* shard = shards_.Local();
+        BufferBlock* block = shard->local[cls];
+        if (!block) {
+            block = shard->remote[cls].exchange(nullptr, std::memory_order_acquire);
+            std::size_t count = 0;
+            for (BufferBlock* it = block; it; it = it->next) {
+                ++count;
+            }
+            // Every block is counted before it is pushed, this never underflows
+            shard->remote_count[cls].fetch_sub(count, std::memory_order_relaxed);
+            shard->local_count[cls] = count;
+        }
+        if (!block) {
+            return IOBuffer(NewBlock_(shard, cls, CLASS_SIZES[cls]));
+        }
+
+        shard->local[cls] = block->next;
+        --shard->local_count[cls];
+        block->next = nullptr;
+        return IOBuffer(block);
+    }
+
+    std::size_t BufferPool::CacheLimit() const noexcept {
+        return cache_limit_;
+    }
+
+    std::size_t BufferPool::BlocksAllocated() const noexcept {
+        return blocks_allocated_.load(std::memory_order_relaxed);
+    }
+
+    void BufferPool::Release_(BufferBlock* block) noexcept {
+        BufferShard* owner = block->owner;
+        const std::size_t cls = block->size_class;
+
+        if (shards_.Find() == owner) {
+            if (owner->local_count[cls] >= cache_limit_) {
+                FreeBlock_(block);
+                return;
+            }
+            block->next = owner->local[cls];
+            owner->local[cls] = block;
+            ++owner->local_count[cls];
+            return;
+        }
+
+        // The owner may never come back for its remote stack, keep it bounded too
+        if (owner->remote_count[cls].fetch_add(1, std::memory_order_relaxed) >= cache_limit_) {
+            owner->remote_count[cls].fetch_sub(1, std::memory_order_relaxed);
+            FreeBlock_(block);
+            return;
+        }
+        BufferBlock* head = owner->remote[cls].load(std::memory_order_relaxed);
+        do {
+            block->next = head;
+        } while (!owner->remote[cls].compare_exchange_weak(
+            head, block, std::memory_order_release, std::memory_order_relaxed
+        ));
+    }
+
+    BufferBlock* BufferPool::NewBlock_(BufferShard* owner, const std::size_t size_class, const std::size_t capacity) {
+        void* memory = ::operator new(sizeof(BufferBlock) + capacity, std::align_val_t{ BLOCK_ALIGN });
+        BufferBlock* block = new (memory) BufferBlock{
+            nullptr,
+            owner,
+            static_cast<std::uint32_t>(capacity),
+            static_cast<std::uint8_t>(size_class)
+        };
+        if (owner) {
+            owner->pool->blocks_allocated_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return block;
+    }
+
+    void BufferPool::FreeBlock_(BufferBlock* block) noexcept {
+        if (block->owner) {
+            block->owner->pool->blocks_allocated_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        block->~BufferBlock();
+        ::operator delete(reinterpret_cast<void*>(block), std::align_val_t{ BLOCK_ALIGN });
+    }
+
+    void BufferPool::FreeLocal_(BufferShard& shard) noexcept {
+        for (std::size_t cls = 0; cls < CLASSES_COUNT; ++cls) {
+            BufferBlock* block = std::exchange(shard.local[cls], nullptr);
+            while (block) {
+                FreeBlock_(std::exchange(block, block->next));
+            }
+            shard.local_count[cls] = 0;
+        }
+    }
+
+    std::size_t BufferPool::ClassFor_(const std::size_t size) noexcept {
+        for (std::size_t cls = 0; cls < CLASSES_COUNT; ++cls) {
+            if (size <= CLASS_SIZES[cls]) {
+                return cls;
+            }
+        }
+        return CLASSES_COUNT;
+    }
+
+}
@@ -0,0 +1,144 @@
+#ifndef INCLUDE_GUARD_VSOCK_BUFFERPOOL_HPP
+#define INCLUDE_GUARD_VSOCK_BUFFERPOOL_HPP
+
+#include <core/shards.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vsock {
+
+    class BufferPool;
+    struct BufferShard;
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // BufferBlock struct declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Header placed in front of every pooled allocation, payload follows it
+    struct alignas(64) BufferBlock {
+        BufferBlock* next;
+        BufferShard* owner;
+        std::uint32_t capacity;
+        std::uint8_t size_class;
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // IOBuffer class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    class IOBuffer {
+    public:
+
+        IOBuffer(const IOBuffer&) = delete;
+        IOBuffer& operator=(const IOBuffer&) = delete;
+
+    public:
+
+        IOBuffer() noexcept;
+        IOBuffer(IOBuffer&& other) noexcept;
+        IOBuffer& operator=(IOBuffer&& other) noexcept;
+        ~IOBuffer();
+
+        char* Data() noexcept;
+        const char* Data() const noexcept;
+        std::size_t Size() const noexcept;
+        std::size_t Capacity() const noexcept;
+        bool Empty() const noexcept;
+
+        void Resize(const std::size_t size);
+        void Release() noexcept;
+
+        explicit operator bool() const noexcept;
+
+    private:
+
+        friend class BufferPool;
+
+        explicit IOBuffer(BufferBlock* block) noexcept;
+
+    private:
+
+        BufferBlock* block_;
+        std::size_t size_;
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // BufferShard struct declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Per-thread cache. Only the owner thread touches local lists,
+    // other threads return blocks through the lock-free remote stacks.
+    // Both are capped by the cache limit of the pool.
+    struct BufferShard {
+        static constexpr std::size_t CLASSES_COUNT = 5;
+
+        BufferPool* pool{ nullptr };
+        std::array<BufferBlock*, CLASSES_COUNT> local{};
+        std::array<std::size_t, CLASSES_COUNT> local_count{};
+        std::array<std::atomic<BufferBlock*>, CLASSES_COUNT> remote{};
+        std::array<std::atomic<std::size_t>, CLASSES_COUNT> remote_count{};
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // BufferPool class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    class BufferPool {
+    public:
+
+        BufferPool(const BufferPool&) = delete;
+        BufferPool(BufferPool&&) = delete;
+        BufferPool& operator=(const BufferPool&) = delete;
+        BufferPool& operator=(BufferPool&&) = delete;
+
+    public:
+
+        static constexpr std::size_t CLASSES_COUNT = BufferShard::CLASSES_COUNT;
+        static constexpr std::array<std::size_t, CLASSES_COUNT> CLASS_SIZES{
+            256, 1024, 4096, 16384, 65536
+        };
+
+        BufferPool();
+        BufferPool(const std::size_t cache_limit);
+        ~BufferPool();
+
+        static BufferPool& Default();
+
+        IOBuffer Acquire(const std::size_t size);
+
+        std::size_t CacheLimit() const noexcept;
+        std::size_t BlocksAllocated() const noexcept;
+
+    private:
+
+        friend class IOBuffer;
+
+        void Release_(BufferBlock* block) noexcept;
+
+        BufferBlock* NewBlock_(BufferShard* owner, const std::size_t size_class, const std::size_t capacity);
+        static void FreeBlock_(BufferBlock* block) noexcept;
+        static void FreeLocal_(BufferShard& shard) noexcept;
+        static std::size_t ClassFor_(const std::size_t size) noexcept;
+
+    private:
+
+        const std::size_t cache_limit_;
+
+        std::atomic<std::size_t> blocks_allocated_;
+
+        // Last member, a thread exiting during destruction still sees the rest
+        ShardRegistry<BufferShard> shards_;
+
+    };
+
+}
+
+#endif // INCLUDE_GUARD_VSOCK_BUFFERPOOL_HPP
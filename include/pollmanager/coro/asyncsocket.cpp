@@ -0,0 +1,176 @@
+#include <pollmanager/coro/asyncsocket.hpp>
+#include <core/error.hpp>
+
+#include <utility>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // AsyncSocket class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    AsyncSocket::AsyncSocket(PollManager* const poll, const SocketID socket_id, const bool inline_resume) :
+        poll_{ poll },
+        socket_id_{ socket_id },
+        state_{ std::make_shared<state_t>() }
+    {
+        #ifdef _WIN32
+        u_long non_blocking = 1;
+        if (::ioctlsocket(socket_id_, FIONBIO, &non_blocking) == VSOCK_SOCKET_ERROR) {
+        #else
+        const int fl = ::fcntl(socket_id_, F_GETFL, 0);
+        if (fl == -1 || ::fcntl(socket_id_, F_SETFL, fl | O_NONBLOCK) == -1) {
+        #endif
+            throw RuntimeError(
+                "Method: AsyncSocket::AsyncSocket()"s,
+                "Message: switch to non-blocking mode failed"s
+            );
+        }
+
+        // Registered without interest, awaiters arm what they need
+        std::shared_ptr<state_t> state = state_;
+        const bool added = poll_->AddFd(
+            socket_id_, PollManager::FdType::SOCKET, PollManager::Ownership::BORROWED, EPOLLONESHOT,
+            [state](const SocketID) {
+                std::coroutine_handle<> reader;
+                std::coroutine_handle<> writer;
+                {
+                    const std::scoped_lock lock(state->mtx);
+                    reader = std::exchange(state->reader, nullptr);
+                    writer = std::exchange(state->writer, nullptr);
+                }
+                // Both retry their syscall, a spurious wakeup just suspends again
+                if (reader) {
+                    reader.resume();
+                }
+                if (writer) {
+                    writer.resume();
+                }
+            }
+        );
+        if (!added) {
+            throw RuntimeError(
+                "Method: AsyncSocket::AsyncSocket()"s,
+                "Message: socket is already registered"s
+            );
+        }
+        poll_->SetInlineDispatch(socket_id_, inline_resume);
+    }
+
+    AsyncSocket::AsyncSocket(PollManager* const poll, const SocketID socket_id) :
+        AsyncSocket(poll, socket_id, false)
+    {}
+
+    AsyncSocket::~AsyncSocket() {
+        poll_->Remove(socket_id_);
+        closesocket(socket_id_);
+    }
+
+    AsyncSocket::WaitAwaiter AsyncSocket::Readable() {
+        return WaitAwaiter(this, false);
+    }
+
+    AsyncSocket::WaitAwaiter AsyncSocket::Writable() {
+        return WaitAwaiter(this, true);
+    }
+
+    CoTask<std::ptrdiff_t> AsyncSocket::Read(char* data, const std::size_t size) {
+        while (true) {
+            #ifdef _WIN32
+            std::ptrdiff_t received = ::recv(socket_id_, data, static_cast<int>(size), 0);
+            #else
+            std::ptrdiff_t received = ::recv(socket_id_, data, size, 0);
+            #endif
+            if (received >= 0 || !VSOCK_WOULD_BLOCK()) {
+                co_return received;
+            }
+            co_await Readable();
+        }
+    }
+
+    CoTask<std::ptrdiff_t> AsyncSocket::Read(IOBuffer& buffer) {
+        std::ptrdiff_t received = co_await Read(buffer.Data(), buffer.Capacity());
+        buffer.Resize(received > 0 ? static_cast<std::size_t>(received) : 0);
+        co_return received;
+    }
+
+    CoTask<std::ptrdiff_t> AsyncSocket::Write(const char* data, const std::size_t size) {
+        std::size_t written = 0;
+        while (written < size) {
+            #ifdef _WIN32
+            std::ptrdiff_t sent = ::send(socket_id_, data + written, static_cast<int>(size - written), 0);
+            #else
+            std::ptrdiff_t sent = ::send(socket_id_, data + written, size - written, MSG_NOSIGNAL);
+            #endif
+            if (sent >= 0) {
+                written += static_cast<std::size_t>(sent);
+                continue;
+            }
+            if (!VSOCK_WOULD_BLOCK()) {
+                co_return VSOCK_SOCKET_ERROR;
+            }
+            co_await Writable();
+        }
+        co_return static_cast<std::ptrdiff_t>(written);
+    }
+
+    CoTask<std::ptrdiff_t> AsyncSocket::Write(const IOBuffer& buffer) {
+        co_return co_await Write(buffer.Data(), buffer.Size());
+    }
+
+    CoTask<SocketID> AsyncSocket::Accept() {
+        while (true) {
+            SocketID client_id = ::accept(socket_id_, nullptr, nullptr);
+            if (client_id != VSOCK_INVALID_SOCKET || !VSOCK_WOULD_BLOCK()) {
+                co_return client_id;
+            }
+            co_await Readable();
+        }
+    }
+
+    SocketID AsyncSocket::Id() const noexcept {
+        return socket_id_;
+    }
+
+    void AsyncSocket::Arm_() {
+        std::uint32_t events = EPOLLONESHOT;
+        if (state_->reader) {
+            events |= EPOLLIN;
+        }
+        if (state_->writer) {
+            events |= EPOLLOUT;
+        }
+        poll_->Modify(socket_id_, events);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // AsyncSocket::WaitAwaiter class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    AsyncSocket::WaitAwaiter::WaitAwaiter(AsyncSocket* const socket, const bool write) :
+        socket_{ socket },
+        write_{ write }
+    {}
+
+    void AsyncSocket::WaitAwaiter::await_suspend(std::coroutine_handle<> handle) {
+        // Interest is recomputed under the state lock so that a reader and a
+        // writer suspending concurrently cannot overwrite each other's flags
+        const std::scoped_lock lock(socket_->state_->mtx);
+        if (write_) {
+            socket_->state_->writer = handle;
+        }
+        else {
+            socket_->state_->reader = handle;
+        }
+        socket_->Arm_();
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Helpers
+    //////////////////////////////////////////////////////////////////////////////////
+
+    CoTask<SocketID> AsyncAccept(AsyncSocket& listener) {
+        return listener.Accept();
+    }
+
+}
@@ -0,0 +1,89 @@
+#ifndef INCLUDE_GUARD_VSOCK_ASYNCSOCKET_HPP
+#define INCLUDE_GUARD_VSOCK_ASYNCSOCKET_HPP
+
+#include <pollmanager/manager/poll.hpp>
+#include <pollmanager/coro/cotask.hpp>
+#include <core/common.hpp>
+
+#include <coroutine>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // AsyncSocket class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Non-blocking socket registered once with the PollManager. Awaiting
+    // readiness arms the matching interest, the waiting coroutine is resumed
+    // by the worker handling the event, or by the reactor itself when
+    // inline_resume is set. One reader and one writer may wait at a time.
+    class AsyncSocket {
+    public:
+
+        AsyncSocket() = delete;
+        AsyncSocket(const AsyncSocket&) = delete;
+        AsyncSocket(AsyncSocket&&) = delete;
+        AsyncSocket& operator=(const AsyncSocket&) = delete;
+        AsyncSocket& operator=(AsyncSocket&&) = delete;
+
+    private:
+
+        typedef struct {
+            std::mutex mtx;
+            std::coroutine_handle<> reader;
+            std::coroutine_handle<> writer;
+        } state_t;
+
+    public:
+
+        class WaitAwaiter {
+        public:
+
+            WaitAwaiter(AsyncSocket* const socket, const bool write);
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle);
+            void await_resume() const noexcept {}
+
+        private:
+
+            AsyncSocket* const socket_;
+            const bool write_;
+
+        };
+
+        AsyncSocket(PollManager* const poll, const SocketID socket_id);
+        AsyncSocket(PollManager* const poll, const SocketID socket_id, const bool inline_resume);
+        ~AsyncSocket();
+
+        WaitAwaiter Readable();
+        WaitAwaiter Writable();
+
+        CoTask<std::ptrdiff_t> Read(char* data, const std::size_t size);
+        CoTask<std::ptrdiff_t> Read(IOBuffer& buffer);
+        CoTask<std::ptrdiff_t> Write(const char* data, const std::size_t size);
+        CoTask<std::ptrdiff_t> Write(const IOBuffer& buffer);
+        CoTask<SocketID> Accept();
+
+        SocketID Id() const noexcept;
+
+    private:
+
+        void Arm_();
+
+    private:
+
+        PollManager* const poll_;
+        const SocketID socket_id_;
+        const std::shared_ptr<state_t> state_;
+
+    };
+
+    CoTask<SocketID> AsyncAccept(AsyncSocket& listener);
+
+}
+
+#endif // INCLUDE_GUARD_VSOCK_ASYNCSOCKET_HPP
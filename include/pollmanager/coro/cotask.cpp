@@ -0,0 +1,26 @@
+#include <pollmanager/coro/cotask.hpp>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // CoPromiseBase class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void CoPromiseBase::unhandled_exception() noexcept {
+        exception_ = std::current_exception();
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Helpers
+    //////////////////////////////////////////////////////////////////////////////////
+
+    void Spawn(CoTask<void>&& task) {
+        auto handle = std::exchange(task.handle_, nullptr);
+        if (!handle) {
+            return;
+        }
+        handle.promise().detached_ = true;
+        handle.resume();
+    }
+
+}
@@ -0,0 +1,186 @@
+#ifndef INCLUDE_GUARD_VSOCK_COTASK_HPP
+#define INCLUDE_GUARD_VSOCK_COTASK_HPP
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace vsock {
+
+    template<typename T>
+    class CoTask;
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // CoPromiseBase class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Lazily started coroutine. Awaiting it starts the body and resumes the
+    // awaiter by symmetric transfer when it finishes. A detached task (see
+    // Spawn()) frees its own frame on completion.
+    class CoPromiseBase {
+    public:
+
+        struct FinalAwaiter {
+            bool await_ready() const noexcept { return false; }
+
+            template<typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept;
+
+            void await_resume() const noexcept {}
+        };
+
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        FinalAwaiter final_suspend() const noexcept { return {}; }
+
+        void unhandled_exception() noexcept;
+
+    protected:
+
+        template<typename T>
+        friend class CoTask;
+        friend void Spawn(CoTask<void>&& task);
+
+        std::coroutine_handle<> continuation_{ nullptr };
+        std::exception_ptr exception_{ nullptr };
+        bool detached_{ false };
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // CoTask class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename T = void>
+    class CoTask {
+    public:
+
+        CoTask(const CoTask&) = delete;
+        CoTask& operator=(const CoTask&) = delete;
+
+    public:
+
+        struct promise_type : public CoPromiseBase {
+            std::optional<T> value;
+
+            CoTask get_return_object() noexcept {
+                return CoTask(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            template<typename U>
+            void return_value(U&& result) {
+                value.emplace(std::forward<U>(result));
+            }
+        };
+
+        CoTask(CoTask&& other) noexcept;
+        CoTask& operator=(CoTask&& other) noexcept;
+        ~CoTask();
+
+        bool await_ready() const noexcept;
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept;
+        T await_resume();
+
+    private:
+
+        friend void Spawn(CoTask<void>&& task);
+
+        explicit CoTask(std::coroutine_handle<promise_type> handle) noexcept;
+
+    private:
+
+        std::coroutine_handle<promise_type> handle_;
+
+    };
+
+    template<>
+    struct CoTask<void>::promise_type : public CoPromiseBase {
+        CoTask get_return_object() noexcept {
+            return CoTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        void return_void() const noexcept {}
+    };
+
+    // Starts the task on the calling thread and lets it run to completion on
+    // whatever thread resumes it, the frame is released when it finishes
+    void Spawn(CoTask<void>&& task);
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // CoPromiseBase class defenition (template methods)
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename Promise>
+    inline std::coroutine_handle<> CoPromiseBase::FinalAwaiter::await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+        CoPromiseBase& promise = handle.promise();
+        if (promise.continuation_) {
+            return promise.continuation_;
+        }
+        if (promise.detached_) {
+            if (promise.exception_) {
+                // Nobody is left to observe the failure
+                std::terminate();
+            }
+            handle.destroy();
+        }
+        return std::noop_coroutine();
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // CoTask class defenition (template methods)
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename T>
+    inline CoTask<T>::CoTask(std::coroutine_handle<promise_type> handle) noexcept :
+        handle_{ handle }
+    {}
+
+    template<typename T>
+    inline CoTask<T>::CoTask(CoTask&& other) noexcept :
+        handle_{ std::exchange(other.handle_, nullptr) }
+    {}
+
+    template<typename T>
+    inline CoTask<T>& CoTask<T>::operator=(CoTask&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    template<typename T>
+    inline CoTask<T>::~CoTask() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    template<typename T>
+    inline bool CoTask<T>::await_ready() const noexcept {
+        return !handle_ || handle_.done();
+    }
+
+    template<typename T>
+    inline std::coroutine_handle<> CoTask<T>::await_suspend(std::coroutine_handle<> awaiter) noexcept {
+        handle_.promise().continuation_ = awaiter;
+        return handle_;
+    }
+
+    template<typename T>
+    inline T CoTask<T>::await_resume() {
+        promise_type& promise = handle_.promise();
+        if (promise.exception_) {
+            std::rethrow_exception(promise.exception_);
+        }
+        if constexpr (!std::is_void_v<T>) {
+            return std::move(*promise.value);
+        }
+    }
+
+}
+
+#endif // INCLUDE_GUARD_VSOCK_COTASK_HPP
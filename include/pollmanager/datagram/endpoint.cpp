@@ -0,0 +1,249 @@
+#include <pollmanager/datagram/endpoint.hpp>
+#include <core/error.hpp>
+
+#ifdef __linux__
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#endif
+
+#include <algorithm>
+#include <vector>
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+
+#define VSOCK_DATAGRAM_BATCH 64
+#define VSOCK_DATAGRAM_SIZE 4096
+#define VSOCK_DATAGRAM_GRO_SIZE 65536
+#define VSOCK_DATAGRAM_DRAIN_ROUNDS 8
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // DatagramEndpoint class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    DatagramEndpoint::DatagramEndpoint(PollManager* const poll, const SocketID socket_id, const std::size_t batch_size, const std::size_t buffer_size) :
+        poll_{ poll },
+        socket_id_{ socket_id },
+        batch_size_{ std::max<std::size_t>(batch_size, 1) },
+        buffer_size_{ buffer_size },
+        gro_{ false },
+        started_{ false },
+        on_batch_{},
+        received_{ 0 },
+        truncated_{ 0 },
+        syscalls_{ 0 }
+    {}
+
+    DatagramEndpoint::DatagramEndpoint(PollManager* const poll, const SocketID socket_id, const std::size_t batch_size) :
+        DatagramEndpoint(poll, socket_id, batch_size, 0)
+    {}
+
+    DatagramEndpoint::DatagramEndpoint(PollManager* const poll, const SocketID socket_id) :
+        DatagramEndpoint(poll, socket_id, VSOCK_DATAGRAM_BATCH, 0)
+    {}
+
+    void DatagramEndpoint::EnableGro() {
+        #ifdef __linux__
+        int one = 1;
+        if (::setsockopt(socket_id_, SOL_UDP, UDP_GRO, &one, sizeof(one)) == VSOCK_SOCKET_ERROR) {
+            throw RuntimeError(
+                "Method: DatagramEndpoint::EnableGro()"s,
+                "Message: ::setsockopt(UDP_GRO) failed"s
+            );
+        }
+        gro_ = true;
+        #endif
+    }
+
+    void DatagramEndpoint::EnableGso(const std::uint16_t segment_size) {
+        #ifdef __linux__
+        // Every send larger than segment_size is split by the stack
+        int size = segment_size;
+        if (::setsockopt(socket_id_, SOL_UDP, UDP_SEGMENT, &size, sizeof(size)) == VSOCK_SOCKET_ERROR) {
+            throw RuntimeError(
+                "Method: DatagramEndpoint::EnableGso()"s,
+                "Message: ::setsockopt(UDP_SEGMENT) failed"s
+            );
+        }
+        #endif
+    }
+
+    void DatagramEndpoint::Start(batch_func_t&& on_batch) {
+        #ifndef __linux__
+        throw RuntimeError(
+            "Method: DatagramEndpoint::Start()"s,
+            "Message: recvmmsg() is available on Linux only"s
+        );
+        #else
+        if (started_) {
+            return;
+        }
+        on_batch_ = std::move(on_batch);
+        started_ = true;
+
+        auto self = shared_from_this();
+        poll_->Add(socket_id_, (EPOLLIN | EPOLLONESHOT), [self](const SocketID) {
+            self->Drain_();
+        });
+        #endif
+    }
+
+    void DatagramEndpoint::Stop() {
+        if (!started_) {
+            return;
+        }
+        started_ = false;
+        poll_->Remove(socket_id_);
+    }
+
+    std::ptrdiff_t DatagramEndpoint::SendBatch(const datagram_t* datagrams, const std::size_t count) {
+        #ifndef __linux__
+        return VSOCK_SOCKET_ERROR;
+        #else
+        std::vector<struct mmsghdr> messages(count);
+        std::vector<struct iovec> iovs(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            iovs[i].iov_base = const_cast<char*>(datagrams[i].data.data());
+            iovs[i].iov_len = datagrams[i].data.size();
+            messages[i].msg_hdr = {};
+            messages[i].msg_hdr.msg_name = const_cast<struct sockaddr*>(datagrams[i].address);
+            messages[i].msg_hdr.msg_namelen = datagrams[i].address ? datagrams[i].address_len : 0;
+            messages[i].msg_hdr.msg_iov = &iovs[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        std::size_t sent = 0;
+        while (sent < count) {
+            int result = ::sendmmsg(
+                socket_id_, messages.data() + sent, static_cast<unsigned int>(count - sent),
+                MSG_DONTWAIT | MSG_NOSIGNAL
+            );
+            syscalls_.fetch_add(1, std::memory_order_relaxed);
+            if (result <= 0) {
+                if (sent == 0) {
+                    return VSOCK_SOCKET_ERROR;
+                }
+                break;
+            }
+            sent += static_cast<std::size_t>(result);
+        }
+        return static_cast<std::ptrdiff_t>(sent);
+        #endif
+    }
+
+    std::size_t DatagramEndpoint::Received() const noexcept {
+        return received_.load(std::memory_order_relaxed);
+    }
+
+    std::size_t DatagramEndpoint::Truncated() const noexcept {
+        return truncated_.load(std::memory_order_relaxed);
+    }
+
+    std::size_t DatagramEndpoint::Syscalls() const noexcept {
+        return syscalls_.load(std::memory_order_relaxed);
+    }
+
+    void DatagramEndpoint::Drain_() {
+        #ifdef __linux__
+        typedef struct {
+            IOBuffer buffer;
+            struct iovec iov;
+            struct sockaddr_storage address;
+            char control[CMSG_SPACE(sizeof(int))];
+        } slot_t;
+
+        const std::size_t buffer_size = buffer_size_ ? buffer_size_ : (gro_ ? VSOCK_DATAGRAM_GRO_SIZE : VSOCK_DATAGRAM_SIZE);
+
+        // Buffers are held for the duration of one drain only
+        std::vector<slot_t> slots(batch_size_);
+        std::vector<struct mmsghdr> messages(batch_size_);
+        std::vector<datagram_t> batch;
+        batch.reserve(batch_size_);
+
+        for (std::size_t i = 0; i < batch_size_; ++i) {
+            slots[i].buffer = poll_->Buffers().Acquire(buffer_size);
+            slots[i].iov.iov_base = slots[i].buffer.Data();
+            slots[i].iov.iov_len = slots[i].buffer.Capacity();
+        }
+
+        for (std::size_t round = 0; round < VSOCK_DATAGRAM_DRAIN_ROUNDS; ++round) {
+            for (std::size_t i = 0; i < batch_size_; ++i) {
+                struct msghdr& hdr = messages[i].msg_hdr;
+                hdr = {};
+                hdr.msg_name = &slots[i].address;
+                hdr.msg_namelen = sizeof(slots[i].address);
+                hdr.msg_iov = &slots[i].iov;
+                hdr.msg_iovlen = 1;
+                hdr.msg_control = gro_ ? slots[i].control : nullptr;
+                hdr.msg_controllen = gro_ ? sizeof(slots[i].control) : 0;
+                messages[i].msg_len = 0;
+            }
+
+            int count = ::recvmmsg(socket_id_, messages.data(), static_cast<unsigned int>(batch_size_), MSG_DONTWAIT, nullptr);
+            syscalls_.fetch_add(1, std::memory_order_relaxed);
+            if (count <= 0) {
+                break;
+            }
+
+            batch.clear();
+            for (int i = 0; i < count; ++i) {
+                const struct msghdr& hdr = messages[i].msg_hdr;
+                const char* data = slots[i].buffer.Data();
+                const std::size_t length = messages[i].msg_len;
+                const struct sockaddr* address = reinterpret_cast<const struct sockaddr*>(&slots[i].address);
+
+                // The tail is already gone, a cut datagram must not pass for a whole one
+                if (hdr.msg_flags & MSG_TRUNC) {
+                    truncated_.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+
+                std::size_t segment = 0;
+                if (gro_) {
+                    for (struct cmsghdr* cm = CMSG_FIRSTHDR(&hdr); cm; cm = CMSG_NXTHDR(const_cast<struct msghdr*>(&hdr), cm)) {
+                        if (cm->cmsg_level == SOL_UDP && cm->cmsg_type == UDP_GRO) {
+                            segment = static_cast<std::size_t>(*reinterpret_cast<const int*>(CMSG_DATA(cm)));
+                        }
+                    }
+                }
+
+                if (segment == 0 || segment >= length) {
+                    batch.push_back({ std::string_view(data, length), address, hdr.msg_namelen });
+                    continue;
+                }
+                // Coalesced by GRO, hand the original datagrams out one by one
+                for (std::size_t offset = 0; offset < length; offset += segment) {
+                    batch.push_back({
+                        std::string_view(data + offset, std::min(segment, length - offset)),
+                        address,
+                        hdr.msg_namelen
+                    });
+                }
+            }
+
+            received_.fetch_add(batch.size(), std::memory_order_relaxed);
+            if (!batch.empty()) {
+                on_batch_(batch.data(), batch.size());
+            }
+
+            if (static_cast<std::size_t>(count) < batch_size_) {
+                break;
+            }
+        }
+        #endif
+
+        poll_->ResetFlags(socket_id_);
+    }
+
+}
@@ -0,0 +1,84 @@
+#ifndef INCLUDE_GUARD_VSOCK_DATAGRAM_ENDPOINT_HPP
+#define INCLUDE_GUARD_VSOCK_DATAGRAM_ENDPOINT_HPP
+
+#include <pollmanager/manager/poll.hpp>
+#include <core/common.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // DatagramEndpoint class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // UDP socket on top of the reactor. Readiness is drained with recvmmsg()
+    // into a batch of pooled buffers and handed over as one call, sends go out
+    // with sendmmsg(). UDP_GRO/UDP_SEGMENT move many datagrams per syscall.
+    class DatagramEndpoint : public std::enable_shared_from_this<DatagramEndpoint> {
+    public:
+
+        DatagramEndpoint() = delete;
+        DatagramEndpoint(const DatagramEndpoint&) = delete;
+        DatagramEndpoint(DatagramEndpoint&&) = delete;
+        DatagramEndpoint& operator=(const DatagramEndpoint&) = delete;
+        DatagramEndpoint& operator=(DatagramEndpoint&&) = delete;
+
+    public:
+
+        typedef struct {
+            std::string_view data;
+            const struct sockaddr* address;
+            socklen_t address_len;
+        } datagram_t;
+
+        typedef std::function<void(const datagram_t* datagrams, const std::size_t count)> batch_func_t;
+
+        DatagramEndpoint(PollManager* const poll, const SocketID socket_id);
+        DatagramEndpoint(PollManager* const poll, const SocketID socket_id, const std::size_t batch_size);
+        // buffer_size is the room per datagram slot, 0 keeps 4096 (65536 with GRO)
+        DatagramEndpoint(PollManager* const poll, const SocketID socket_id, const std::size_t batch_size, const std::size_t buffer_size);
+
+        void EnableGro();
+        void EnableGso(const std::uint16_t segment_size);
+
+        void Start(batch_func_t&& on_batch);
+        void Stop();
+
+        std::ptrdiff_t SendBatch(const datagram_t* datagrams, const std::size_t count);
+
+        std::size_t Received() const noexcept;
+        // Datagrams larger than a receive buffer, dropped instead of handed out cut
+        std::size_t Truncated() const noexcept;
+        std::size_t Syscalls() const noexcept;
+
+    private:
+
+        void Drain_();
+
+    private:
+
+        PollManager* const poll_;
+        const SocketID socket_id_;
+        const std::size_t batch_size_;
+        const std::size_t buffer_size_;
+
+        bool gro_;
+        bool started_;
+
+        batch_func_t on_batch_;
+
+        std::atomic<std::size_t> received_;
+        std::atomic<std::size_t> truncated_;
+        std::atomic<std::size_t> syscalls_;
+
+    };
+
+}
+
+#endif // INCLUDE_GUARD_VSOCK_DATAGRAM_ENDPOINT_HPP
@@ -0,0 +1,64 @@
+#include <pollmanager/fd/eventcounter.hpp>
+#include <core/error.hpp>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // EventCounter class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    EventCounter::EventCounter(const bool semaphore) :
+        fd_{ -1 }
+    {
+        #ifdef _WIN32
+        throw RuntimeError(
+            "Method: EventCounter::EventCounter()"s,
+            "Message: eventfd() is not available on this platform"s
+        );
+        #else
+        fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC | (semaphore ? EFD_SEMAPHORE : 0));
+        if (fd_ == -1) {
+            throw RuntimeError(
+                "Method: EventCounter::EventCounter()"s,
+                "Message: eventfd() failed"s
+            );
+        }
+        #endif
+    }
+
+    EventCounter::EventCounter() :
+        EventCounter(false)
+    {}
+
+    EventCounter::~EventCounter() {
+        #ifndef _WIN32
+        ::close(fd_);
+        #endif
+    }
+
+    void EventCounter::Notify(const std::uint64_t value) {
+        #ifndef _WIN32
+        if (::write(fd_, &value, sizeof(value)) != sizeof(value)) {
+            throw RuntimeError(
+                "Method: EventCounter::Notify()"s,
+                "Message: ::write() failed"s
+            );
+        }
+        #endif
+    }
+
+    std::uint64_t EventCounter::Take() {
+        std::uint64_t value = 0;
+        #ifndef _WIN32
+        if (::read(fd_, &value, sizeof(value)) != sizeof(value)) {
+            return 0;
+        }
+        #endif
+        return value;
+    }
+
+    int EventCounter::Fd() const noexcept {
+        return fd_;
+    }
+
+}
@@ -0,0 +1,42 @@
+#ifndef INCLUDE_GUARD_VSOCK_EVENTCOUNTER_HPP
+#define INCLUDE_GUARD_VSOCK_EVENTCOUNTER_HPP
+
+#include <core/common.hpp>
+
+#include <cstdint>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // EventCounter class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Non-blocking eventfd, register with FdType::EVENT and Ownership::BORROWED
+    class EventCounter {
+    public:
+
+        EventCounter(const EventCounter&) = delete;
+        EventCounter(EventCounter&&) = delete;
+        EventCounter& operator=(const EventCounter&) = delete;
+        EventCounter& operator=(EventCounter&&) = delete;
+
+    public:
+
+        EventCounter();
+        EventCounter(const bool semaphore);
+        ~EventCounter();
+
+        void Notify(const std::uint64_t value = 1);
+        std::uint64_t Take();
+
+        int Fd() const noexcept;
+
+    private:
+
+        int fd_;
+
+    };
+
+}
+
+#endif // INCLUDE_GUARD_VSOCK_EVENTCOUNTER_HPP
@@ -0,0 +1,125 @@
+#include <pollmanager/fd/signalreceiver.hpp>
+#include <core/error.hpp>
+
+#ifdef __linux__
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/signalfd.h>
+#endif
+
+namespace vsock {
+
+    #ifdef __linux__
+    namespace {
+
+        sigset_t MakeMask(std::initializer_list<int> signals) {
+            sigset_t mask;
+            sigemptyset(&mask);
+            for (const int signal : signals) {
+                sigaddset(&mask, signal);
+            }
+            return mask;
+        }
+
+        // Every other thread must block the signals already, one that does not
+        // takes them before the signalfd sees them. Unknown without /proc.
+        bool OthersBlock(std::initializer_list<int> signals) {
+            DIR* tasks = ::opendir("/proc/self/task");
+            if (!tasks) {
+                return true;
+            }
+            const std::string self = std::to_string(::gettid());
+            bool blocked = true;
+            while (struct dirent* entry = ::readdir(tasks)) {
+                const std::string tid = entry->d_name;
+                if (tid == "." || tid == ".." || tid == self) {
+                    continue;
+                }
+                std::ifstream status("/proc/self/task/"s + tid + "/status"s);
+                std::string line;
+                while (std::getline(status, line)) {
+                    if (line.rfind("SigBlk:", 0) != 0) {
+                        continue;
+                    }
+                    const unsigned long long mask = std::strtoull(line.c_str() + 7, nullptr, 16);
+                    for (const int signal : signals) {
+                        blocked = blocked && (mask & (1ULL << (signal - 1)));
+                    }
+                    break;
+                }
+            }
+            ::closedir(tasks);
+            return blocked;
+        }
+
+    }
+    #endif
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // SignalReceiver class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    SignalReceiver::SignalReceiver(std::initializer_list<int> signals) :
+        fd_{ -1 }
+    {
+        #ifndef __linux__
+        throw RuntimeError(
+            "Method: SignalReceiver::SignalReceiver()"s,
+            "Message: signalfd is not available on this platform"s
+        );
+        #else
+        if (!OthersBlock(signals)) {
+            throw RuntimeError(
+                "Method: SignalReceiver::SignalReceiver()"s,
+                "Message: a running thread does not block the signals, construct before starting threads or call Block()"s
+            );
+        }
+        Block(signals);
+        const sigset_t mask = MakeMask(signals);
+        fd_ = ::signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+        if (fd_ == -1) {
+            throw RuntimeError(
+                "Method: SignalReceiver::SignalReceiver()"s,
+                "Message: ::signalfd() failed"s
+            );
+        }
+        #endif
+    }
+
+    SignalReceiver::~SignalReceiver() {
+        #ifdef __linux__
+        ::close(fd_);
+        #endif
+    }
+
+    void SignalReceiver::Block(std::initializer_list<int> signals) {
+        #ifdef __linux__
+        const sigset_t mask = MakeMask(signals);
+        if (::pthread_sigmask(SIG_BLOCK, &mask, nullptr) != 0) {
+            throw RuntimeError(
+                "Method: SignalReceiver::Block()"s,
+                "Message: ::pthread_sigmask() failed"s
+            );
+        }
+        #endif
+    }
+
+    int SignalReceiver::Take() {
+        #ifdef __linux__
+        struct signalfd_siginfo info;
+        if (::read(fd_, &info, sizeof(info)) == sizeof(info)) {
+            return static_cast<int>(info.ssi_signo);
+        }
+        #endif
+        return 0;
+    }
+
+    int SignalReceiver::Fd() const noexcept {
+        return fd_;
+    }
+
+}
@@ -0,0 +1,47 @@
+#ifndef INCLUDE_GUARD_VSOCK_SIGNALRECEIVER_HPP
+#define INCLUDE_GUARD_VSOCK_SIGNALRECEIVER_HPP
+
+#include <core/common.hpp>
+
+#include <initializer_list>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // SignalReceiver class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Non-blocking signalfd, register with FdType::SIGNAL and Ownership::BORROWED.
+    // A signal mask is per thread and only inherited by threads created later:
+    // construct it before any ThreadPool is started, or call Block() first.
+    // Construction fails while another thread still has the signals unblocked.
+    class SignalReceiver {
+    public:
+
+        SignalReceiver() = delete;
+        SignalReceiver(const SignalReceiver&) = delete;
+        SignalReceiver(SignalReceiver&&) = delete;
+        SignalReceiver& operator=(const SignalReceiver&) = delete;
+        SignalReceiver& operator=(SignalReceiver&&) = delete;
+
+    public:
+
+        SignalReceiver(std::initializer_list<int> signals);
+        ~SignalReceiver();
+
+        // Blocks the signals in the calling thread, threads it starts inherit it
+        static void Block(std::initializer_list<int> signals);
+
+        int Take();
+
+        int Fd() const noexcept;
+
+    private:
+
+        int fd_;
+
+    };
+
+}
+
+#endif // INCLUDE_GUARD_VSOCK_SIGNALRECEIVER_HPP
@@ -0,0 +1,86 @@
+#include <pollmanager/fd/timer.hpp>
+#include <core/error.hpp>
+
+#ifdef __linux__
+#include <sys/timerfd.h>
+#endif
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Timer class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    Timer::Timer() :
+        fd_{ -1 }
+    {
+        #ifndef __linux__
+        throw RuntimeError(
+            "Method: Timer::Timer()"s,
+            "Message: timerfd is not available on this platform"s
+        );
+        #else
+        fd_ = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (fd_ == -1) {
+            throw RuntimeError(
+                "Method: Timer::Timer()"s,
+                "Message: ::timerfd_create() failed"s
+            );
+        }
+        #endif
+    }
+
+    Timer::~Timer() {
+        #ifdef __linux__
+        ::close(fd_);
+        #endif
+    }
+
+    void Timer::Arm(const std::chrono::nanoseconds initial, const std::chrono::nanoseconds interval) {
+        #ifdef __linux__
+        auto to_timespec = [](const std::chrono::nanoseconds value) {
+            struct timespec ts;
+            ts.tv_sec = static_cast<time_t>(value.count() / 1000000000);
+            ts.tv_nsec = static_cast<long>(value.count() % 1000000000);
+            return ts;
+        };
+        struct itimerspec spec;
+        // Zero initial value would disarm the timer
+        spec.it_value = to_timespec(initial.count() > 0 ? initial : std::chrono::nanoseconds(1));
+        spec.it_interval = to_timespec(interval);
+        if (::timerfd_settime(fd_, 0, &spec, nullptr) == -1) {
+            throw RuntimeError(
+                "Method: Timer::Arm()"s,
+                "Message: ::timerfd_settime() failed"s
+            );
+        }
+        #endif
+    }
+
+    void Timer::Disarm() {
+        #ifdef __linux__
+        struct itimerspec spec {};
+        if (::timerfd_settime(fd_, 0, &spec, nullptr) == -1) {
+            throw RuntimeError(
+                "Method: Timer::Disarm()"s,
+                "Message: ::timerfd_settime() failed"s
+            );
+        }
+        #endif
+    }
+
+    std::uint64_t Timer::Take() {
+        std::uint64_t expirations = 0;
+        #ifdef __linux__
+        if (::read(fd_, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+            return 0;
+        }
+        #endif
+        return expirations;
+    }
+
+    int Timer::Fd() const noexcept {
+        return fd_;
+    }
+
+}
@@ -0,0 +1,43 @@
+#ifndef INCLUDE_GUARD_VSOCK_TIMER_HPP
+#define INCLUDE_GUARD_VSOCK_TIMER_HPP
+
+#include <core/common.hpp>
+
+#include <chrono>
+#include <cstdint>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Timer class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Non-blocking monotonic timerfd, register with FdType::TIMER and Ownership::BORROWED
+    class Timer {
+    public:
+
+        Timer(const Timer&) = delete;
+        Timer(Timer&&) = delete;
+        Timer& operator=(const Timer&) = delete;
+        Timer& operator=(Timer&&) = delete;
+
+    public:
+
+        Timer();
+        ~Timer();
+
+        void Arm(const std::chrono::nanoseconds initial, const std::chrono::nanoseconds interval);
+        void Disarm();
+        std::uint64_t Take();
+
+        int Fd() const noexcept;
+
+    private:
+
+        int fd_;
+
+    };
+
+}
+
+#endif // INCLUDE_GUARD_VSOCK_TIMER_HPP
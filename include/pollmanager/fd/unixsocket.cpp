@@ -0,0 +1,153 @@
+#include <pollmanager/fd/unixsocket.hpp>
+#include <core/error.hpp>
+
+#include <cerrno>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <sys/un.h>
+#endif
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // UnixSocket class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    #ifndef _WIN32
+    namespace {
+
+        struct sockaddr_un MakeAddress(const std::string& path, const char* method) {
+            struct sockaddr_un address {};
+            if (path.size() >= sizeof(address.sun_path)) {
+                throw RuntimeError(
+                    "Method: "s + method,
+                    "Message: path is too long"s
+                );
+            }
+            address.sun_family = AF_UNIX;
+            path.copy(address.sun_path, path.size());
+            return address;
+        }
+
+    }
+    #endif
+
+    SocketID UnixSocket::Listen(const std::string& path, const int backlog) {
+        #ifdef _WIN32
+        throw RuntimeError(
+            "Method: UnixSocket::Listen()"s,
+            "Message: Unix-domain sockets are not supported on this platform"s
+        );
+        #else
+        struct sockaddr_un address = MakeAddress(path, "UnixSocket::Listen()");
+        SocketID socket_id = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (socket_id == VSOCK_INVALID_SOCKET) {
+            throw RuntimeError(
+                "Method: UnixSocket::Listen()"s,
+                "Message: ::socket() failed"s
+            );
+        }
+        // Only a stale socket is replaced, never a file that happens to sit there
+        struct stat st;
+        if (::lstat(path.c_str(), &st) == 0) {
+            if (!S_ISSOCK(st.st_mode)) {
+                ::close(socket_id);
+                throw RuntimeError(
+                    "Method: UnixSocket::Listen()"s,
+                    "Message: "s + path + " exists and is not a socket"s
+                );
+            }
+            // A live server accepts or queues the probe, only a refused one is stale
+            const SocketID probe_id = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (probe_id == VSOCK_INVALID_SOCKET) {
+                ::close(socket_id);
+                throw RuntimeError(
+                    "Method: UnixSocket::Listen()"s,
+                    "Message: ::socket() failed"s
+                );
+            }
+            int probe_error = 0;
+            if (::connect(probe_id, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == VSOCK_SOCKET_ERROR) {
+                probe_error = errno;
+            }
+            ::close(probe_id);
+            // ENOENT: gone since lstat(), bind() takes the path as it is
+            if (probe_error != ECONNREFUSED && probe_error != ENOENT) {
+                ::close(socket_id);
+                errno = EADDRINUSE;
+                throw RuntimeError(
+                    "Method: UnixSocket::Listen()"s,
+                    "Message: "s + path + " is in use"s
+                );
+            }
+            if (probe_error == ECONNREFUSED) {
+                ::unlink(path.c_str());
+            }
+        }
+        if (::bind(socket_id, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == VSOCK_SOCKET_ERROR ||
+            ::listen(socket_id, backlog) == VSOCK_SOCKET_ERROR) {
+            ::close(socket_id);
+            throw RuntimeError(
+                "Method: UnixSocket::Listen()"s,
+                "Message: ::bind() or ::listen() failed for "s + path
+            );
+        }
+        return socket_id;
+        #endif
+    }
+
+    SocketID UnixSocket::Connect(const std::string& path) {
+        #ifdef _WIN32
+        throw RuntimeError(
+            "Method: UnixSocket::Connect()"s,
+            "Message: Unix-domain sockets are not supported on this platform"s
+        );
+        #else
+        struct sockaddr_un address = MakeAddress(path, "UnixSocket::Connect()");
+        SocketID socket_id = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (socket_id == VSOCK_INVALID_SOCKET) {
+            throw RuntimeError(
+                "Method: UnixSocket::Connect()"s,
+                "Message: ::socket() failed"s
+            );
+        }
+        // Local connects complete immediately or fail, EAGAIN means a full backlog
+        if (::connect(socket_id, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == VSOCK_SOCKET_ERROR) {
+            ::close(socket_id);
+            throw RuntimeError(
+                "Method: UnixSocket::Connect()"s,
+                "Message: ::connect() failed for "s + path
+            );
+        }
+        return socket_id;
+        #endif
+    }
+
+    SocketID UnixSocket::Accept(const SocketID listen_socket) {
+        #ifdef _WIN32
+        return VSOCK_INVALID_SOCKET;
+        #else
+        return ::accept4(listen_socket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        #endif
+    }
+
+    std::pair<SocketID, SocketID> UnixSocket::Pair() {
+        #ifdef _WIN32
+        throw RuntimeError(
+            "Method: UnixSocket::Pair()"s,
+            "Message: Unix-domain sockets are not supported on this platform"s
+        );
+        #else
+        int fds[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds) == -1) {
+            throw RuntimeError(
+                "Method: UnixSocket::Pair()"s,
+                "Message: ::socketpair() failed"s
+            );
+        }
+        return { fds[0], fds[1] };
+        #endif
+    }
+
+}
@@ -0,0 +1,32 @@
+#ifndef INCLUDE_GUARD_VSOCK_UNIXSOCKET_HPP
+#define INCLUDE_GUARD_VSOCK_UNIXSOCKET_HPP
+
+#include <core/common.hpp>
+
+#include <string>
+#include <utility>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // UnixSocket class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Non-blocking Unix-domain stream sockets, register with FdType::UNIX
+    class UnixSocket {
+    public:
+
+        UnixSocket() = delete;
+
+    public:
+
+        static SocketID Listen(const std::string& path, const int backlog);
+        static SocketID Connect(const std::string& path);
+        static SocketID Accept(const SocketID listen_socket);
+        static std::pair<SocketID, SocketID> Pair();
+
+    };
+
+}
+
+#endif // INCLUDE_GUARD_VSOCK_UNIXSOCKET_HPP
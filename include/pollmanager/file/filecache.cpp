@@ -0,0 +1,195 @@
+#include <pollmanager/file/filecache.hpp>
+#include <core/error.hpp>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define VSOCK_FILECACHE_CAPACITY (64 * 1024 * 1024)
+#define VSOCK_FILECACHE_MAX_OBJECT (256 * 1024)
+
+namespace vsock {
+
+    #ifndef _WIN32
+    namespace {
+
+        // Nanoseconds, a same-size rewrite within one second is still noticed
+        inline std::int64_t ModifyTimeNs(const struct stat& st) noexcept {
+            return static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000LL +
+                static_cast<std::int64_t>(st.st_mtim.tv_nsec);
+        }
+
+    }
+    #endif
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // MappedFile class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    MappedFile::MappedFile(const std::string& path) :
+        data_{ nullptr },
+        size_{ 0 },
+        mtime_{ 0 }
+    {
+        #ifdef _WIN32
+        throw RuntimeError(
+            "Method: MappedFile::MappedFile()"s,
+            "Message: file mapping is not supported on this platform"s
+        );
+        #else
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1) {
+            throw RuntimeError(
+                "Method: MappedFile::MappedFile()"s,
+                "Message: ::open() failed for "s + path
+            );
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) == -1) {
+            ::close(fd);
+            throw RuntimeError(
+                "Method: MappedFile::MappedFile()"s,
+                "Message: ::fstat() failed for "s + path
+            );
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        mtime_ = ModifyTimeNs(st);
+
+        if (size_ > 0) {
+            void* data = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+            if (data == MAP_FAILED) {
+                ::close(fd);
+                throw RuntimeError(
+                    "Method: MappedFile::MappedFile()"s,
+                    "Message: ::mmap() failed for "s + path
+                );
+            }
+            data_ = data;
+        }
+        ::close(fd);
+        #endif
+    }
+
+    MappedFile::~MappedFile() {
+        #ifndef _WIN32
+        if (data_) {
+            ::munmap(data_, size_);
+        }
+        #endif
+    }
+
+    const char* MappedFile::Data() const noexcept {
+        return static_cast<const char*>(data_);
+    }
+
+    std::size_t MappedFile::Size() const noexcept {
+        return size_;
+    }
+
+    std::int64_t MappedFile::ModifyTime() const noexcept {
+        return mtime_;
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // FileCache class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    FileCache::FileCache(const std::size_t capacity, const std::size_t max_object_size) :
+        capacity_{ capacity },
+        max_object_size_{ max_object_size },
+        size_{ 0 }
+    {}
+
+    FileCache::FileCache() :
+        FileCache(VSOCK_FILECACHE_CAPACITY, VSOCK_FILECACHE_MAX_OBJECT)
+    {}
+
+    FileCache& FileCache::Default() {
+        static FileCache cache;
+        return cache;
+    }
+
+    FileCache::file_ptr_t FileCache::Get(const std::string& path) {
+        #ifdef _WIN32
+        return nullptr;
+        #else
+        struct stat st;
+        if (::stat(path.c_str(), &st) == -1 || !S_ISREG(st.st_mode)) {
+            return nullptr;
+        }
+        const std::size_t size = static_cast<std::size_t>(st.st_size);
+        if (size > max_object_size_) {
+            return nullptr;
+        }
+
+        const std::scoped_lock lock(mtx_);
+        auto it = entries_.find(path);
+        if (it != entries_.end()) {
+            const file_ptr_t& file = it->second.file;
+            if (file->Size() == size && file->ModifyTime() == ModifyTimeNs(st)) {
+                lru_.splice(lru_.begin(), lru_, it->second.lru);
+                return file;
+            }
+            size_ -= file->Size();
+            lru_.erase(it->second.lru);
+            entries_.erase(it);
+        }
+
+        file_ptr_t file;
+        try {
+            file = std::make_shared<const MappedFile>(path);
+        }
+        catch (const RuntimeError&) {
+            // Unreadable or replaced since stat(), the caller takes the uncached path
+            return nullptr;
+        }
+        lru_.push_front(path);
+        entries_.insert({ path, { file, lru_.begin() } });
+        size_ += file->Size();
+        Evict_();
+        return file;
+        #endif
+    }
+
+    void FileCache::Invalidate(const std::string& path) {
+        const std::scoped_lock lock(mtx_);
+        auto it = entries_.find(path);
+        if (it == entries_.end()) {
+            return;
+        }
+        size_ -= it->second.file->Size();
+        lru_.erase(it->second.lru);
+        entries_.erase(it);
+    }
+
+    void FileCache::Clear() {
+        const std::scoped_lock lock(mtx_);
+        entries_.clear();
+        lru_.clear();
+        size_ = 0;
+    }
+
+    std::size_t FileCache::Size() const noexcept {
+        const std::scoped_lock lock(mtx_);
+        return size_;
+    }
+
+    std::size_t FileCache::MaxObjectSize() const noexcept {
+        return max_object_size_;
+    }
+
+    void FileCache::Evict_() {
+        // Mappings still used by transfers stay alive through their shared_ptr
+        while (size_ > capacity_ && lru_.size() > 1) {
+            auto it = entries_.find(lru_.back());
+            size_ -= it->second.file->Size();
+            entries_.erase(it);
+            lru_.pop_back();
+        }
+    }
+
+}
@@ -0,0 +1,99 @@
+#ifndef INCLUDE_GUARD_VSOCK_FILECACHE_HPP
+#define INCLUDE_GUARD_VSOCK_FILECACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // MappedFile class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    class MappedFile {
+    public:
+
+        MappedFile() = delete;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile(MappedFile&&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile& operator=(MappedFile&&) = delete;
+
+    public:
+
+        MappedFile(const std::string& path);
+        ~MappedFile();
+
+        const char* Data() const noexcept;
+        std::size_t Size() const noexcept;
+        // Nanoseconds since the epoch
+        std::int64_t ModifyTime() const noexcept;
+
+    private:
+
+        void* data_;
+        std::size_t size_;
+        std::int64_t mtime_;
+
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // FileCache class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // LRU of read-only mappings of small hot files, entries are revalidated
+    // against size and mtime on every lookup
+    class FileCache {
+    public:
+
+        FileCache(const FileCache&) = delete;
+        FileCache(FileCache&&) = delete;
+        FileCache& operator=(const FileCache&) = delete;
+        FileCache& operator=(FileCache&&) = delete;
+
+    public:
+
+        typedef std::shared_ptr<const MappedFile> file_ptr_t;
+
+        FileCache();
+        FileCache(const std::size_t capacity, const std::size_t max_object_size);
+
+        static FileCache& Default();
+
+        file_ptr_t Get(const std::string& path);
+        void Invalidate(const std::string& path);
+        void Clear();
+
+        std::size_t Size() const noexcept;
+        std::size_t MaxObjectSize() const noexcept;
+
+    private:
+
+        typedef struct {
+            file_ptr_t file;
+            std::list<std::string>::iterator lru;
+        } entry_t;
+
+        void Evict_();
+
+    private:
+
+        const std::size_t capacity_;
+        const std::size_t max_object_size_;
+
+        std::size_t size_;
+        std::list<std::string> lru_;
+        std::unordered_map<std::string, entry_t> entries_;
+
+        mutable std::mutex mtx_;
+
+    };
+
+}
+
+#endif // INCLUDE_GUARD_VSOCK_FILECACHE_HPP
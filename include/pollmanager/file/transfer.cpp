@@ -0,0 +1,143 @@
+#include <pollmanager/file/transfer.hpp>
+
+#ifdef __linux__
+#include <sys/sendfile.h>
+#include <sys/uio.h>
+#endif
+
+#include <algorithm>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // FileTransfer class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    FileTransfer::FileTransfer(
+        const SocketID socket_id,
+        std::string&& headers,
+        const int file_fd,
+        const std::uint64_t offset,
+        const std::uint64_t length,
+        const bool own_fd
+    ) :
+        socket_id_{ socket_id },
+        headers_{ std::move(headers) },
+        file_{ nullptr },
+        file_fd_{ file_fd },
+        own_fd_{ own_fd },
+        headers_sent_{ 0 },
+        offset_{ offset },
+        remaining_{ length },
+        sent_{ 0 }
+    {}
+
+    FileTransfer::FileTransfer(
+        const SocketID socket_id,
+        std::string&& headers,
+        const FileCache::file_ptr_t& file
+    ) :
+        socket_id_{ socket_id },
+        headers_{ std::move(headers) },
+        file_{ file },
+        file_fd_{ -1 },
+        own_fd_{ false },
+        headers_sent_{ 0 },
+        offset_{ 0 },
+        remaining_{ file->Size() },
+        sent_{ 0 }
+    {}
+
+    FileTransfer::~FileTransfer() {
+        #ifndef _WIN32
+        if (own_fd_ && file_fd_ != -1) {
+            ::close(file_fd_);
+        }
+        #endif
+    }
+
+    FileTransfer::Status FileTransfer::Continue() {
+        #ifdef __linux__
+        return file_ ? ContinueMapped_() : ContinueSendfile_();
+        #else
+        return Status::FAILED;
+        #endif
+    }
+
+    std::uint64_t FileTransfer::Sent() const noexcept {
+        return sent_;
+    }
+
+    std::uint64_t FileTransfer::Total() const noexcept {
+        return headers_.size() + sent_ + remaining_;
+    }
+
+    FileTransfer::Status FileTransfer::ContinueMapped_() {
+        #ifdef __linux__
+        while (headers_sent_ < headers_.size() || remaining_ > 0) {
+            struct iovec iov[2];
+            int iov_count = 0;
+            if (headers_sent_ < headers_.size()) {
+                iov[iov_count].iov_base = const_cast<char*>(headers_.data() + headers_sent_);
+                iov[iov_count].iov_len = headers_.size() - headers_sent_;
+                ++iov_count;
+            }
+            if (remaining_ > 0) {
+                iov[iov_count].iov_base = const_cast<char*>(file_->Data() + offset_);
+                iov[iov_count].iov_len = static_cast<std::size_t>(remaining_);
+                ++iov_count;
+            }
+
+            // Gathered send, same as writev() but without SIGPIPE on a closed peer
+            struct msghdr msg {};
+            msg.msg_iov = iov;
+            msg.msg_iovlen = static_cast<std::size_t>(iov_count);
+            ssize_t written = ::sendmsg(socket_id_, &msg, MSG_NOSIGNAL);
+            if (written == -1) {
+                return VSOCK_WOULD_BLOCK() ? Status::AGAIN : Status::FAILED;
+            }
+
+            std::size_t left = static_cast<std::size_t>(written);
+            const std::size_t from_headers = std::min(left, headers_.size() - headers_sent_);
+            headers_sent_ += from_headers;
+            left -= from_headers;
+            offset_ += left;
+            remaining_ -= left;
+            sent_ += left;
+        }
+        #endif
+        return Status::DONE;
+    }
+
+    FileTransfer::Status FileTransfer::ContinueSendfile_() {
+        #ifdef __linux__
+        while (headers_sent_ < headers_.size()) {
+            ssize_t written = ::send(
+                socket_id_, headers_.data() + headers_sent_, headers_.size() - headers_sent_,
+                (remaining_ > 0 ? MSG_MORE : 0) | MSG_NOSIGNAL
+            );
+            if (written == -1) {
+                return VSOCK_WOULD_BLOCK() ? Status::AGAIN : Status::FAILED;
+            }
+            headers_sent_ += static_cast<std::size_t>(written);
+        }
+
+        while (remaining_ > 0) {
+            off_t offset = static_cast<off_t>(offset_);
+            ssize_t written = ::sendfile(socket_id_, file_fd_, &offset, static_cast<std::size_t>(remaining_));
+            if (written == -1) {
+                return VSOCK_WOULD_BLOCK() ? Status::AGAIN : Status::FAILED;
+            }
+            if (written == 0) {
+                // File is shorter than promised
+                return Status::FAILED;
+            }
+            offset_ = static_cast<std::uint64_t>(offset);
+            remaining_ -= static_cast<std::uint64_t>(written);
+            sent_ += static_cast<std::uint64_t>(written);
+        }
+        #endif
+        return Status::DONE;
+    }
+
+}
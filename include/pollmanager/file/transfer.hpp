@@ -0,0 +1,82 @@
+#ifndef INCLUDE_GUARD_VSOCK_FILE_TRANSFER_HPP
+#define INCLUDE_GUARD_VSOCK_FILE_TRANSFER_HPP
+
+#include <pollmanager/file/filecache.hpp>
+#include <core/common.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // FileTransfer class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Headers followed by file payload. Cached files go out with writev() from
+    // their mapping, anything else with sendfile(). Offsets survive partial
+    // sends so Continue() resumes where the socket stopped accepting data.
+    class FileTransfer {
+    public:
+
+        FileTransfer() = delete;
+        FileTransfer(const FileTransfer&) = delete;
+        FileTransfer(FileTransfer&&) = delete;
+        FileTransfer& operator=(const FileTransfer&) = delete;
+        FileTransfer& operator=(FileTransfer&&) = delete;
+
+    public:
+
+        enum class Status : std::uint8_t {
+            DONE,
+            AGAIN,
+            FAILED
+        };
+
+        typedef std::function<void(const SocketID, const bool)> done_func_t;
+
+        FileTransfer(
+            const SocketID socket_id,
+            std::string&& headers,
+            const int file_fd,
+            const std::uint64_t offset,
+            const std::uint64_t length,
+            const bool own_fd
+        );
+        FileTransfer(
+            const SocketID socket_id,
+            std::string&& headers,
+            const FileCache::file_ptr_t& file
+        );
+        ~FileTransfer();
+
+        Status Continue();
+
+        std::uint64_t Sent() const noexcept;
+        std::uint64_t Total() const noexcept;
+
+    private:
+
+        Status ContinueMapped_();
+        Status ContinueSendfile_();
+
+    private:
+
+        const SocketID socket_id_;
+        const std::string headers_;
+        const FileCache::file_ptr_t file_;
+        const int file_fd_;
+        const bool own_fd_;
+
+        std::size_t headers_sent_;
+        std::uint64_t offset_;
+        std::uint64_t remaining_;
+        std::uint64_t sent_;
+
+    };
+
+}
+
+#endif // INCLUDE_GUARD_VSOCK_FILE_TRANSFER_HPP
@@ -1,201 +1,1390 @@
 #include <pollmanager/manager/poll.hpp>
 #include <core/error.hpp>
+#include <core/trace.hpp>
 #include <algorithm>
+#include <exception>
+#include <string>
+#include <thread>
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
 #include <iostream>
 
 using namespace std;
 
+// Marks a strand as scheduled or running, never reported by epoll_wait()
+#define VSOCK_STRAND_RUNNING (1U << 22)
+// Asks the strand to close the socket once the running handler returns
+#define VSOCK_STRAND_CLOSE (1U << 23)
+
 namespace vsock {
 
-    PollManager::PollManager(ThreadPool* const thread_pool) :
-        epollfd_{ NULL },
-        thread_pool_{ thread_pool },
-        epoll_result_{ nullptr },
-        is_alive_{ false },
-        poll_running_{ false },
-        is_stoping_{ false },
-        abort_event_fd_{ 0 }
-    {
-        CreateEpoll_();
+    namespace {
+
+        // Bytes read by the manager on behalf of the running handler
+        thread_local std::uint64_t handler_bytes{ 0 };
+
+        inline std::uint64_t ThreadCpuNs() noexcept {
+            #ifdef _WIN32
+            return 0;
+            #else
+            struct timespec ts;
+            ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+            return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<std::uint64_t>(ts.tv_nsec);
+            #endif
+        }
+
+        // A running file transfer waits for EPOLLOUT, a close handler still hears the hangup
+        inline std::uint32_t TransferEvents(const std::uint32_t flags) noexcept {
+            return EPOLLOUT | EPOLLONESHOT | (flags & EPOLLRDHUP);
+        }
+
+        // Reads and clears the pending socket error, zero when there is none
+        inline int PendingError(const SocketID socket_id) noexcept {
+            int error = 0;
+            socklen_t length = sizeof(error);
+            if (::getsockopt(socket_id, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &length) != 0) {
+                return -1;
+            }
+            return error;
+        }
+
+    }
+
+    PollManager::PollManager(ThreadPool* const thread_pool) :
+        PollManager(thread_pool, &BufferPool::Default())
+    {}
+
+    PollManager::PollManager(ThreadPool* const thread_pool, BufferPool* const buffer_pool) :
+        epollfd_{ NULL },
+        thread_pool_{ thread_pool },
+        buffer_pool_{ buffer_pool },
+        file_cache_{ &FileCache::Default() },
+        epoll_result_{ nullptr },
+        is_alive_{ false },
+        poll_running_{ false },
+        is_stoping_{ false },
+        draining_{ false },
+        abort_event_fd_{ 0 },
+        post_event_fd_{ -1 },
+        post_pending_{ false },
+        ready_{},
+        ready_pending_{ false },
+        budget_bytes_{ 0 },
+        budget_reads_{ 0 },
+        affinity_{ false },
+        reactor_worker_{ VSOCK_ANY_WORKER },
+        in_flight_{ 0 },
+        releasing_{ 0 },
+        max_in_flight_{ 0 },
+        max_socket_in_flight_{ 0 },
+        throttled_{},
+        throttled_count_{ 0 },
+        resume_posted_{ false },
+        watchdog_{ thread_pool->ThreadsCount() },
+        profiling_{ false }
+    {
+        CreateEpoll_();
+    }
+
+    PollManager::~PollManager() {
+        watchdog_.Stop();
+        Stop_();
+        DestroyEpoll_();
+    }
+
+    void PollManager::Add(
+        const SocketID socket_id,
+        const std::uint32_t flags,
+        callback_func_t&& callback,
+        const Priority priority,
+        close_func_t&& on_close
+    ) {
+        // Plain sockets keep the original contract: the manager closes them
+        AddFd(
+            socket_id, FdType::SOCKET, Ownership::OWNED, flags, std::forward<callback_func_t>(callback),
+            false, priority, std::forward<close_func_t>(on_close)
+        );
+    }
+
+    bool PollManager::AddFd(
+        const SocketID socket_id,
+        const FdType type,
+        const Ownership ownership,
+        const std::uint32_t flags,
+        callback_func_t&& callback,
+        const bool serial,
+        const Priority priority,
+        close_func_t&& on_close
+    ) {
+        if (is_stoping_ || draining_) {
+            return false;
+        }
+
+        {
+            std::scoped_lock queue_lock(queue_mtx_);
+            if (!Insert_({
+                .socket_id = socket_id,
+                .flags = flags,
+                .callback = std::forward<callback_func_t>(callback),
+                .type = type,
+                .ownership = ownership,
+                .serial = serial,
+                .priority = priority,
+                .on_close = std::forward<close_func_t>(on_close)
+            })) {
+                return false;
+            }
+        }
+
+        // Only the caller that flips the flag starts the reactor
+        if (!is_alive_.exchange(true)) {
+            Start_();
+        }
+        data_cv_.notify_all();
+        return true;
+
+    }
+
+    void PollManager::AddSerial(
+        const SocketID socket_id,
+        const std::uint32_t flags,
+        callback_func_t&& callback
+    ) {
+        AddFd(socket_id, FdType::SOCKET, Ownership::OWNED, flags, std::forward<callback_func_t>(callback), true);
+    }
+
+    void PollManager::AddReader(
+        const SocketID socket_id,
+        const std::uint32_t flags,
+        read_callback_func_t&& callback
+    ) {
+        // Buffer is taken from the pool only while data is in flight,
+        // an idle connection holds no receive memory at all
+        Add(socket_id, flags, [this, read_callback = std::move(callback)](const SocketID id) {
+            // Without a budget the socket is read once per event
+            const std::size_t max_bytes = budget_bytes_;
+            const std::size_t max_reads = budget_reads_;
+            const bool budgeted = (max_bytes > 0 || max_reads > 0);
+            std::size_t bytes = 0;
+            std::size_t reads = 0;
+            while (true) {
+                IOBuffer buffer = buffer_pool_->Acquire(VSOCK_READ_BUFFER_SIZE);
+                #ifdef _WIN32
+                int received = ::recv(id, buffer.Data(), static_cast<int>(buffer.Capacity()), 0);
+                #else
+                ssize_t received = ::recv(id, buffer.Data(), buffer.Capacity(), 0);
+                #endif
+                if (received > 0) {
+                    buffer.Resize(static_cast<std::size_t>(received));
+                    handler_bytes += static_cast<std::uint64_t>(received);
+                }
+                else if (received == VSOCK_SOCKET_ERROR && VSOCK_WOULD_BLOCK()) {
+                    return;
+                }
+                else {
+                    // Peer closed or socket failed, handler gets an empty buffer
+                    buffer.Release();
+                }
+                read_callback(id, std::move(buffer));
+
+                if (!budgeted || received <= 0) {
+                    return;
+                }
+                bytes += static_cast<std::size_t>(received);
+                ++reads;
+                if ((max_bytes > 0 && bytes >= max_bytes) || (max_reads > 0 && reads >= max_reads)) {
+                    // Budget is spent, the rest is read after other ready sockets
+                    Requeue(id);
+                    return;
+                }
+            }
+        });
+    }
+
+    void PollManager::AddZeroCopyReader(
+        const SocketID socket_id,
+        const std::uint32_t flags,
+        view_callback_func_t&& callback
+    ) {
+        auto receiver = std::make_shared<ZeroCopyReceiver>(socket_id, buffer_pool_);
+        Add(socket_id, flags, [receiver, view_callback = std::move(callback)](const SocketID id) {
+            std::ptrdiff_t received = receiver->Receive([&view_callback, id](std::string_view view) {
+                view_callback(id, view);
+            });
+            if (received == 0 || (received == VSOCK_SOCKET_ERROR && !VSOCK_WOULD_BLOCK())) {
+                // Peer closed or socket failed, handler gets an empty view
+                view_callback(id, std::string_view());
+            }
+        });
+    }
+
+    void PollManager::Remove(const SocketID socket_id) {
+        if (!is_alive_ || is_stoping_) {
+            return;
+        }
+
+        {
+            std::scoped_lock queue_lock(queue_mtx_);
+
+            auto it = queue_.find(socket_id);
+            if (it == queue_.end()) {
+                return;
+            }
+            if (it->second.strand) {
+                it->second.strand->removed = true;
+            }
+
+            if (EpollCtl_(EPOLL_CTL_DEL, socket_id, NULL) == -1) {
+                throw RuntimeError(
+                    "Method: PollManager::Remove()"s,
+                    "Message: ::epoll_ctl() failed"s
+                );
+            }
+
+            queue_.erase(socket_id);
+
+        }
+
+    }
+
+    std::size_t PollManager::AddBatch(std::span<registration_t> registrations) {
+        if (is_stoping_ || draining_) {
+            return 0;
+        }
+
+        // One lock, one rehash and one wakeup for the whole batch. Each fd
+        // still costs one epoll_ctl(), there is no batched form of it.
+        std::size_t added = 0;
+        std::exception_ptr error;
+        {
+            std::scoped_lock queue_lock(queue_mtx_);
+            queue_.reserve(queue_.size() + registrations.size());
+
+            for (registration_t& registration : registrations) {
+                // A failed fd does not hold back the rest, the first failure is reported
+                try {
+                    added += Insert_(std::move(registration));
+                }
+                catch (const RuntimeError&) {
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                }
+            }
+        }
+
+        if (added > 0) {
+            if (!is_alive_.exchange(true)) {
+                Start_();
+            }
+            data_cv_.notify_all();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return added;
+    }
+
+    std::size_t PollManager::RemoveBatch(std::span<const SocketID> sockets) {
+        if (!is_alive_ || is_stoping_) {
+            return 0;
+        }
+
+        std::size_t removed = 0;
+        std::exception_ptr error;
+        {
+            std::scoped_lock queue_lock(queue_mtx_);
+            for (const SocketID socket_id : sockets) {
+                auto it = queue_.find(socket_id);
+                if (it == queue_.end()) {
+                    continue;
+                }
+                // Same as Remove(): the record stays and the failure is thrown
+                if (EpollCtl_(EPOLL_CTL_DEL, socket_id, NULL) == -1) {
+                    if (!error) {
+                        error = std::make_exception_ptr(RuntimeError(
+                            "Method: PollManager::RemoveBatch()"s,
+                            "Message: ::epoll_ctl() failed for "s + std::to_string(socket_id)
+                        ));
+                    }
+                    continue;
+                }
+                if (it->second.strand) {
+                    it->second.strand->removed = true;
+                }
+                queue_.erase(it);
+                ++removed;
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return removed;
+    }
+
+    bool PollManager::Insert_(registration_t&& registration) {
+        // Peer shutdown is only reported when asked for
+        const std::uint32_t events = registration.on_close ? (registration.flags | EPOLLRDHUP) : registration.flags;
+
+        std::shared_ptr<strand_t> strand;
+        if (registration.serial) {
+            strand = std::make_shared<strand_t>();
+            strand->state = 0;
+            strand->removed = false;
+            strand->callback = registration.callback;
+        }
+
+        auto res = queue_.insert(
+            {
+                registration.socket_id,
+                {
+                    .flags = events,
+                    .type = registration.type,
+                    .ownership = registration.ownership,
+                    .callback = std::move(registration.callback),
+                    .strand = std::move(strand),
+                    .stats = std::make_shared<socket_stats_t>(),
+                    .priority = registration.priority,
+                    .on_close = std::move(registration.on_close)
+                }
+            }
+        );
+        if (res.second == false) {
+            return false;
+        }
+
+        struct epoll_event ev;
+        ev.events = events;
+        ev.data.fd = registration.socket_id;
+        if (EpollCtl_(EPOLL_CTL_ADD, registration.socket_id, &ev) == -1) {
+            // Nothing is left behind for an fd epoll refused
+            RuntimeError error(
+                "Method: PollManager::Insert_()"s,
+                "Message: ::epoll_ctl() failed for "s + std::to_string(registration.socket_id)
+            );
+            queue_.erase(res.first);
+            throw error;
+        }
+        return true;
+    }
+
+    void PollManager::Post(post_func_t&& job) {
+        if (is_stoping_) {
+            return;
+        }
+        posted_.Push(std::forward<post_func_t>(job));
+        // Only the caller that flips the flag starts the reactor
+        if (!is_alive_.exchange(true)) {
+            Start_();
+        }
+        data_cv_.notify_all();
+        // One wakeup covers every closure posted until the reactor drains the queue
+        if (!post_pending_.exchange(true)) {
+            SendPostSignal_();
+        }
+    }
+
+    void PollManager::Requeue(const SocketID socket_id) {
+        if (is_stoping_) {
+            return;
+        }
+        {
+            std::scoped_lock ready_lock(ready_mtx_);
+            ready_.push_back(socket_id);
+        }
+        ready_pending_ = true;
+        // Reactor may be blocked in epoll_wait(), the post event wakes it up
+        if (!post_pending_.exchange(true)) {
+            SendPostSignal_();
+        }
+    }
+
+    void PollManager::SetReadBudget(const std::size_t bytes, const std::size_t reads) noexcept {
+        budget_bytes_ = bytes;
+        budget_reads_ = reads;
+    }
+
+    bool PollManager::Drain(
+        const std::chrono::steady_clock::time_point deadline,
+        std::vector<SocketID>* released
+    ) {
+        if (is_stoping_ || draining_.exchange(true)) {
+            return false;
+        }
+
+        // Stop new events, listeners included, before waiting for handlers
+        {
+            std::scoped_lock queue_lock(queue_mtx_);
+            for (const auto& [id, value] : queue_) {
+                if (!value.closing && !value.throttled) {
+                    struct epoll_event ev;
+                    ev.events = EPOLLONESHOT;
+                    ev.data.fd = id;
+                    EpollCtl_(EPOLL_CTL_MOD, id, &ev);
+                }
+            }
+        }
+        {
+            std::scoped_lock ready_lock(ready_mtx_);
+            ready_.clear();
+            ready_pending_ = false;
+        }
+
+        bool drained = false;
+        {
+            std::unique_lock drain_lock(drain_mtx_);
+            drained = drain_cv_.wait_until(drain_lock, deadline, [this] { return in_flight_ == 0; });
+        }
+
+        std::unordered_map<SocketID, queue_record_t> queue;
+        {
+            std::scoped_lock queue_lock(queue_mtx_);
+            queue.swap(queue_);
+            throttled_.clear();
+            throttled_count_ = 0;
+        }
+        for (auto& [id, value] : queue) {
+            if (value.strand) {
+                value.strand->removed = true;
+            }
+            if (value.ownership == Ownership::OWNED && !released) {
+                // Closing the last reference removes it from epoll as well
+                CloseFd_(id, value.type);
+                continue;
+            }
+            EpollCtl_(EPOLL_CTL_DEL, id, NULL);
+            if (released) {
+                released->push_back(id);
+            }
+        }
+
+        draining_ = false;
+        return drained;
+    }
+
+    void PollManager::Start_() {
+        // Running from the moment it is queued, Stop_() must not return
+        // before a task that has not started yet is done with this
+        {
+            std::scoped_lock stop_cv_lock(stop_cv_mtx_);
+            poll_running_ = true;
+        }
+        (*thread_pool_).AddAsyncTask([this]() {
+            // Affine handlers must not queue up behind the reactor loop
+            reactor_worker_ = thread_pool_->CurrentWorker();
+            Poll_();
+            std::unique_lock stop_cv_lock(stop_cv_mtx_);
+            poll_running_ = false;
+            stop_cv_.notify_one();
+        });
+
+    }
+
+    void PollManager::Stop_() {
+        is_stoping_ = true;
+        is_alive_ = false;
+        data_cv_.notify_all();
+        SendAbortSignal_();
+
+        std::unique_lock stop_cv_lock(stop_cv_mtx_);
+        while (poll_running_) {
+            stop_cv_.wait(stop_cv_lock);
+        }
+        stop_cv_lock.unlock();
+
+        // Queued and running handlers hold this, they finish before owned fds close
+        {
+            std::unique_lock drain_lock(drain_mtx_);
+            drain_cv_.wait(drain_lock, [this] { return in_flight_ == 0; });
+        }
+        // The last ones may still be checking throttled sockets, that is short
+        while (releasing_ > 0) {
+            std::this_thread::yield();
+        }
+
+        ClearPollsAndQueue_();
+    }
+
+    void PollManager::Poll_() {
+        std::unique_lock data_cv_lock(data_cv_mtx_);
+        while (is_alive_) {
+            while (queue_.empty() && posted_.Empty() && is_alive_ && !is_stoping_) {
+                data_cv_.wait(data_cv_lock);
+            }
+
+            if (!is_alive_ || is_stoping_) {
+                return;
+            }
+
+            // Requeued sockets are pending, only collect what is already ready
+            const int timeout = ready_pending_ ? 0 : VSOCK_EPOLL_TIMEOUT;
+            int nfds = epoll_wait(epollfd_, epoll_result_, VSOCK_EPOLL_MAX_EVENTS, timeout);
+
+            if (!is_alive_ || is_stoping_) {
+                return;
+            }
+
+            if (nfds == -1) {
+                #ifndef _WIN32
+                // Any handled signal interrupts the wait, set*id() broadcasts one too
+                if (errno == EINTR) {
+                    continue;
+                }
+                #endif
+                throw RuntimeError(
+                    "Method: PollManager::Poll_()"s,
+                    "Message: ::epoll_wait() failed"s
+                );
+            }
+
+            VSOCK_TRACE(epoll_wait, nfds, 0);
+            metrics_.Add(Metrics::Counter::EPOLL_WAITS);
+            metrics_.Add(Metrics::Counter::EVENTS, static_cast<std::uint64_t>(nfds));
+            metrics_.Record(Metrics::Histogram::NFDS, static_cast<std::uint64_t>(nfds));
+
+            for (int n = 0; n < nfds; ++n) {
+
+                SocketID socket_id = epoll_result_[n].data.fd;
+
+                if (socket_id == post_event_fd_) {
+                    ClearPostSignal_();
+                    continue;
+                }
+
+                Route_(socket_id, epoll_result_[n].events);
+
+            }
+
+            // Requeued sockets go after the fresh events of this batch
+            RouteReady_();
+
+            // Posted closures run between event batches, on the reactor thread
+            post_pending_.store(false);
+            posted_.Run();
+
+        }
+    }
+
+    void PollManager::RouteReady_() {
+        if (!ready_pending_) {
+            return;
+        }
+        std::deque<SocketID> ready;
+        {
+            std::scoped_lock ready_lock(ready_mtx_);
+            ready.swap(ready_);
+            ready_pending_ = false;
+        }
+        for (const SocketID socket_id : ready) {
+            Route_(socket_id, EPOLLIN);
+        }
+    }
+
+    void PollManager::Close_(const SocketID socket_id, const std::uint32_t events) {
+        callback_func_t callback;
+        std::shared_ptr<socket_stats_t> stats;
+        close_func_t on_close;
+        FileTransfer::done_func_t transfer_done;
+        {
+            std::scoped_lock queue_lock(queue_mtx_);
+            auto it = queue_.find(socket_id);
+            if (it == queue_.end()) {
+                return;
+            }
+            on_close = it->second.on_close;
+            // A transfer cut short by the hangup is reported as failed
+            if (it->second.transfer) {
+                it->second.transfer.reset();
+                transfer_done = std::move(it->second.transfer_done);
+            }
+            // Data that arrived before the shutdown is still delivered
+            if ((events & EPOLLIN) && !(events & EPOLLERR) && !it->second.transfer) {
+                callback = it->second.callback;
+                stats = it->second.stats;
+            }
+        }
+        if (callback) {
+            Invoke_(socket_id, callback, stats.get());
+        }
+        if (transfer_done) {
+            transfer_done(socket_id, false);
+        }
+
+        // Cleared by SetCloseHandler() after the hangup was routed
+        if (on_close && watchdog_.Running()) {
+            const std::size_t slot = thread_pool_->CurrentWorker();
+            watchdog_.Begin(slot, socket_id, "close handler");
+            on_close(socket_id, events);
+            watchdog_.End(slot);
+        }
+        else if (on_close) {
+            on_close(socket_id, events);
+        }
+
+        FdType type = FdType::OTHER;
+        Ownership ownership = Ownership::BORROWED;
+        {
+            std::scoped_lock queue_lock(queue_mtx_);
+            auto it = queue_.find(socket_id);
+            // Handler may have removed the socket itself
+            if (it == queue_.end() || !it->second.closing) {
+                return;
+            }
+            if (it->second.strand) {
+                it->second.strand->removed = true;
+            }
+            type = it->second.type;
+            ownership = it->second.ownership;
+            if (is_alive_ && !is_stoping_) {
+                EpollCtl_(EPOLL_CTL_DEL, socket_id, NULL);
+            }
+            queue_.erase(it);
+        }
+        if (ownership == Ownership::OWNED) {
+            CloseFd_(socket_id, type);
+        }
+    }
+
+    void PollManager::RunStrand_(
+        const SocketID socket_id,
+        const std::shared_ptr<strand_t>& strand,
+        const std::shared_ptr<socket_stats_t>& stats
+    ) {
+        while (true) {
+            // Take the pending events, the strand stays marked as running
+            const std::uint32_t state = strand->state.exchange(VSOCK_STRAND_RUNNING);
+            if (strand->removed) {
+                strand->state = 0;
+                return;
+            }
+            // The socket is gone after this, the strand stays running for good
+            if (state & VSOCK_STRAND_CLOSE) {
+                Close_(socket_id, state & ~(VSOCK_STRAND_RUNNING | VSOCK_STRAND_CLOSE));
+                return;
+            }
+            Invoke_(socket_id, strand->callback, stats.get());
+
+            std::uint32_t expected = VSOCK_STRAND_RUNNING;
+            if (strand->state.compare_exchange_strong(expected, 0)) {
+                return;
+            }
+            // New events arrived while the handler was running, replay them
+        }
+    }
+
+    void PollManager::Dispatch_(const SocketID socket_id) {
+        callback_func_t callback;
+        std::shared_ptr<socket_stats_t> stats;
+        std::shared_ptr<FileTransfer> transfer;
+        {
+            std::scoped_lock queue_lock(queue_mtx_);
+            auto it = queue_.find(socket_id);
+            if (it == queue_.end()) {
+                return;
+            }
+            transfer = it->second.transfer;
+            if (!transfer) {
+                callback = it->second.callback;
+                stats = it->second.stats;
+            }
+        }
+        if (transfer) {
+            ContinueTransfer_(socket_id, transfer);
+            return;
+        }
+        Invoke_(socket_id, callback, stats.get());
+    }
+
+    void PollManager::Invoke_(const SocketID socket_id, const callback_func_t& callback, socket_stats_t* const stats) {
+        const bool profiling = (stats && profiling_);
+        const bool watching = watchdog_.Running();
+        if (!profiling && !watching) {
+            VSOCK_TRACE(handler_start, socket_id, 0);
+            callback(socket_id);
+            VSOCK_TRACE(handler_end, socket_id, 0);
+            return;
+        }
+
+        // The socket id names the handler, every registration has exactly one
+        const std::size_t slot = watching ? thread_pool_->CurrentWorker() : VSOCK_ANY_WORKER;
+        if (watching) {
+            watchdog_.Begin(slot, socket_id, "handler");
+        }
+        const std::uint64_t cpu_started = profiling ? ThreadCpuNs() : 0;
+        handler_bytes = 0;
+
+        VSOCK_TRACE(handler_start, socket_id, 0);
+        callback(socket_id);
+        VSOCK_TRACE(handler_end, socket_id, 0);
+
+        if (profiling) {
+            stats->cpu_ns.fetch_add(ThreadCpuNs() - cpu_started, std::memory_order_relaxed);
+            stats->bytes.fetch_add(handler_bytes, std::memory_order_relaxed);
+        }
+        if (watching) {
+            watchdog_.End(slot);
+        }
+    }
+
+    int PollManager::EpollCtl_(const int operation, const SocketID fd, struct epoll_event* event) {
+        VSOCK_TRACE(epoll_ctl, operation, fd);
+        metrics_.Add(Metrics::Counter::EPOLL_CTLS);
+        return epoll_ctl(epollfd_, operation, fd, event);
+    }
+
+    void PollManager::Arm_(const SocketID socket_id, const std::uint32_t events) {
+        struct epoll_event ev;
+        ev.events = events;
+        ev.data.fd = socket_id;
+        if (EpollCtl_(EPOLL_CTL_MOD, socket_id, &ev) == -1) {
+            throw RuntimeError(
+                "Method: PollManager::Arm_()"s,
+                "Message: ::epoll_ctl() failed"s
+            );
+        }
+    }
+
+    void PollManager::ResetFlags(const SocketID socket_id) {
+        if (!is_alive_ || is_stoping_) {
+            return;
+        }
+        {
+            std::scoped_lock queue_lock(queue_mtx_);
+
+            auto it = queue_.find(socket_id);
+            if (it == queue_.end() || it->second.throttled || it->second.closing || draining_) {
+                // Throttled sockets are rearmed once the pool drains
+                return;
+            }
+
+            struct epoll_event ev;
+            // Socket stays on EPOLLOUT until its file transfer is finished
+            ev.events = it->second.transfer ? TransferEvents(it->second.flags) : it->second.flags;
+            ev.data.fd = socket_id;
+            if (EpollCtl_(EPOLL_CTL_MOD, socket_id, &ev) == -1) {
+                throw RuntimeError(
+                    "Method: PollManager::ResetFlags_()"s,
+                    "Message: ::epoll_ctl() failed"s
+                );
+            }
+        }
+    }
+
+    void PollManager::Modify(const SocketID socket_id, const std::uint32_t flags) {
+        if (!is_alive_ || is_stoping_) {
+            return;
+        }
+        {
+            std::scoped_lock queue_lock(queue_mtx_);
+
+            auto it = queue_.find(socket_id);
+            if (it == queue_.end()) {
+                return;
+            }
+
+            it->second.flags = it->second.on_close ? (flags | EPOLLRDHUP) : flags;
+            if (it->second.throttled || it->second.closing || draining_) {
+                return;
+            }
+
+            struct epoll_event ev;
+            ev.events = it->second.flags;
+            ev.data.fd = socket_id;
+            if (EpollCtl_(EPOLL_CTL_MOD, socket_id, &ev) == -1) {
+                throw RuntimeError(
+                    "Method: PollManager::Modify()"s,
+                    "Message: ::epoll_ctl() failed"s
+                );
+            }
+        }
+    }
+
+    void PollManager::SetInlineDispatch(const SocketID socket_id, const bool inline_dispatch) {
+        std::scoped_lock queue_lock(queue_mtx_);
+
+        auto it = queue_.find(socket_id);
+        if (it != queue_.end()) {
+            it->second.inline_dispatch = inline_dispatch;
+        }
+    }
+
+    void PollManager::SetPriority(const SocketID socket_id, const Priority priority) {
+        std::scoped_lock queue_lock(queue_mtx_);
+
+        auto it = queue_.find(socket_id);
+        if (it == queue_.end()) {
+            throw RuntimeError(
+                "Method: PollManager::SetPriority()"s,
+                "Message: socket is not registered"s
+            );
+        }
+        it->second.priority = priority;
+    }
+
+    void PollManager::SetCloseHandler(const SocketID socket_id, close_func_t&& on_close) {
+        std::scoped_lock queue_lock(queue_mtx_);
+
+        auto it = queue_.find(socket_id);
+        if (it == queue_.end()) {
+            throw RuntimeError(
+                "Method: PollManager::SetCloseHandler()"s,
+                "Message: socket is not registered"s
+            );
+        }
+        it->second.on_close = std::move(on_close);
+        if (!it->second.on_close || (it->second.flags & EPOLLRDHUP)) {
+            return;
+        }
+        it->second.flags |= EPOLLRDHUP;
+        // A disarmed ONESHOT socket picks the flag up on its next rearm
+        if (!(it->second.flags & EPOLLONESHOT) && !it->second.throttled && !it->second.closing) {
+            Arm_(socket_id, it->second.flags);
+        }
+    }
+
+    void PollManager::SetAffinity(const bool affinity) noexcept {
+        affinity_ = affinity;
+    }
+
+    // The worker is a ThreadPool::CurrentWorker() index. Should the reactor
+    // start on it later, the socket is placed like an unbound one instead.
+    void PollManager::Bind(const SocketID socket_id, const std::size_t worker) {
+        if (worker >= thread_pool_->ThreadsCount()) {
+            throw RuntimeError(
+                "Method: PollManager::Bind()"s,
+                "Message: worker index is out of range"s
+            );
+        }
+        if (worker == reactor_worker_) {
+            throw RuntimeError(
+                "Method: PollManager::Bind()"s,
+                "Message: worker runs the reactor loop"s
+            );
+        }
+        std::scoped_lock queue_lock(queue_mtx_);
+
+        auto it = queue_.find(socket_id);
+        if (it == queue_.end()) {
+            throw RuntimeError(
+                "Method: PollManager::Bind()"s,
+                "Message: socket is not registered"s
+            );
+        }
+        it->second.worker = worker;
+    }
+
+    std::size_t PollManager::Worker_(const SocketID socket_id, const std::size_t bound) const noexcept {
+        const std::size_t reactor = reactor_worker_;
+        const std::size_t threads = thread_pool_->ThreadsCount();
+        if (bound != VSOCK_ANY_WORKER && bound < threads && bound != reactor) {
+            return bound;
+        }
+        if (bound == VSOCK_ANY_WORKER && !affinity_) {
+            return VSOCK_ANY_WORKER;
+        }
+        const std::size_t count = threads - (reactor == VSOCK_ANY_WORKER ? 0 : 1);
+        if (count == 0) {
+            return VSOCK_ANY_WORKER;
+        }
+        std::size_t worker = std::hash<SocketID>()(socket_id) % count;
+        // Skip the worker occupied by the reactor loop
+        if (reactor != VSOCK_ANY_WORKER && worker >= reactor) {
+            ++worker;
+        }
+        return worker;
     }
 
-    PollManager::~PollManager() {
-        Stop_();
-        DestroyEpoll_();
+    void PollManager::SetBackpressure(const std::size_t max_in_flight, const std::size_t max_socket_in_flight) noexcept {
+        max_in_flight_ = max_in_flight;
+        max_socket_in_flight_ = max_socket_in_flight;
+        // Loosened limits may free sockets throttled under the old ones
+        if (throttled_count_ > 0 && !resume_posted_.exchange(true)) {
+            Post([this]() { ResumeThrottled_(); });
+        }
     }
 
-    void PollManager::Add(
-        const SocketID socket_id,
-        const std::uint32_t flags,
-        callback_func_t&& callback
+    std::size_t PollManager::InFlight() const noexcept {
+        return in_flight_;
+    }
+
+    void PollManager::Enqueue_(
+        // Read by the enqueue tracepoint only
+        [[maybe_unused]] const SocketID socket_id,
+        const std::size_t worker,
+        const Priority priority,
+        post_func_t&& job
     ) {
-        if (is_stoping_) {
-            return;
+        VSOCK_TRACE(enqueue, socket_id, worker);
+        std::unique_ptr<Task> task(std::make_unique<Task>());
+        if (metrics_.Enabled()) {
+            task->SetAsyncJob([this, enqueued = Metrics::Now(), job = std::move(job)]() {
+                const std::uint64_t started = Metrics::Now();
+                metrics_.Record(Metrics::Histogram::QUEUE_DELAY, started - enqueued);
+                job();
+                metrics_.Record(Metrics::Histogram::HANDLER_TIME, Metrics::Now() - started);
+                metrics_.Add(Metrics::Counter::TASKS);
+            });
         }
-        {
-            std::scoped_lock queue_lock(queue_mtx_);
+        else {
+            task->SetAsyncJob(std::move(job));
+        }
+        (*thread_pool_).AddAffineTask(worker, priority, std::move(task));
+    }
 
-            auto res = queue_.insert(
-                {
-                    socket_id,
-                    {
-                        flags,
-                        std::forward<callback_func_t>(callback)
-                    }
-                }
-            );
+    bool PollManager::Throttle_(const SocketID socket_id, queue_record_t& record) {
+        if (record.throttled) {
+            return true;
+        }
+        const std::size_t max_in_flight = max_in_flight_;
+        const std::size_t max_socket_in_flight = max_socket_in_flight_;
+        if (!(max_in_flight > 0 && in_flight_ >= max_in_flight) &&
+            !(max_socket_in_flight > 0 && record.stats->in_flight >= max_socket_in_flight)) {
+            return false;
+        }
+        // Readiness is not lost: rearming with EPOLL_CTL_MOD reports it again
+        record.throttled = true;
+        metrics_.Add(Metrics::Counter::THROTTLED);
+        throttled_.push_back(socket_id);
+        ++throttled_count_;
+        Arm_(socket_id, EPOLLONESHOT);
+        return true;
+    }
 
-            if (res.second == false) {
-                return;
+    void PollManager::Release_(const std::shared_ptr<socket_stats_t>& stats) {
+        --stats->in_flight;
+        // Keeps the destructor out until this returns, the count alone
+        // lets it go as soon as the last handler has decremented it
+        ++releasing_;
+        const std::size_t left = --in_flight_;
+        if (left == 0 && (draining_ || is_stoping_)) {
+            std::scoped_lock drain_lock(drain_mtx_);
+            drain_cv_.notify_all();
+        }
+        // Resume below half of the global limit so sockets do not flap
+        const std::size_t max_in_flight = max_in_flight_;
+        if (throttled_count_ > 0 && !(max_in_flight > 0 && left > max_in_flight / 2)) {
+            if (!resume_posted_.exchange(true)) {
+                Post([this]() { ResumeThrottled_(); });
             }
+        }
+        --releasing_;
+    }
 
+    void PollManager::ResumeThrottled_() {
+        resume_posted_ = false;
+        if (draining_) {
+            return;
+        }
+        const std::size_t max_in_flight = max_in_flight_;
+        const std::size_t max_socket_in_flight = max_socket_in_flight_;
+        if (max_in_flight > 0 && in_flight_ >= max_in_flight) {
+            return;
         }
 
-        struct epoll_event ev;
-        ev.events = flags;
-        ev.data.fd = socket_id;
+        std::scoped_lock queue_lock(queue_mtx_);
+        std::size_t kept = 0;
+        for (const SocketID socket_id : throttled_) {
+            auto it = queue_.find(socket_id);
+            if (it == queue_.end() || !it->second.throttled) {
+                --throttled_count_;
+                continue;
+            }
+            if (max_socket_in_flight > 0 && it->second.stats->in_flight >= max_socket_in_flight) {
+                throttled_[kept++] = socket_id;
+                continue;
+            }
+            it->second.throttled = false;
+            --throttled_count_;
+            Arm_(socket_id, it->second.transfer ? TransferEvents(it->second.flags) : it->second.flags);
+        }
+        throttled_.resize(kept);
+    }
+
+    PollManager::ReadyAwaiter PollManager::Readable(const SocketID fd) {
+        return ReadyAwaiter(this, fd, EPOLLIN);
+    }
+
+    PollManager::ReadyAwaiter PollManager::Writable(const SocketID fd) {
+        return ReadyAwaiter(this, fd, EPOLLOUT);
+    }
+
+    PollManager::ReadyAwaiter::ReadyAwaiter(PollManager* const poll, const SocketID fd, const std::uint32_t events) :
+        poll_{ poll },
+        fd_{ fd },
+        events_{ events }
+    {}
 
-        if (epoll_ctl(epollfd_, EPOLL_CTL_ADD, socket_id, &ev) == -1) {
+    void PollManager::ReadyAwaiter::await_suspend(std::coroutine_handle<> handle) {
+        // Nothing of the awaiter may be touched once the fd is armed,
+        // the coroutine can already be running on another thread
+        PollManager* const poll = poll_;
+        const bool added = !(poll->is_stoping_ || poll->draining_) && poll->AddFd(
+            fd_, FdType::OTHER, Ownership::BORROWED, (events_ | EPOLLONESHOT),
+            [poll, handle](const SocketID id) {
+                poll->Remove(id);
+                handle.resume();
+            }
+        );
+        // AddFd() refuses every fd while the manager drains or stops
+        if (!added && (poll->is_stoping_ || poll->draining_)) {
             throw RuntimeError(
-                "Method: PollManager::Add()"s,
-                "Message: ::epoll_ctl() failed"s
+                "Method: PollManager::ReadyAwaiter::await_suspend()"s,
+                "Message: manager is draining or stopping"s
             );
         }
+        if (!added) {
+            throw RuntimeError(
+                "Method: PollManager::ReadyAwaiter::await_suspend()"s,
+                "Message: fd is already registered, use AsyncSocket for registered fds"s
+            );
+        }
+    }
 
+    void PollManager::EnableZeroCopy(const SocketID socket_id) {
+        std::scoped_lock queue_lock(queue_mtx_);
 
-        if (!is_alive_) {
-            Start_();
+        auto it = queue_.find(socket_id);
+        if (it == queue_.end()) {
+            throw RuntimeError(
+                "Method: PollManager::EnableZeroCopy()"s,
+                "Message: socket is not registered"s
+            );
         }
-        data_cv_.notify_all();
+        if (!it->second.zerocopy) {
+            it->second.zerocopy = std::make_shared<ZeroCopySender>(socket_id);
+        }
+    }
 
+    std::ptrdiff_t PollManager::SendZeroCopy(
+        const SocketID socket_id,
+        const ZeroCopySender::shared_buffer_t& buffer,
+        const std::size_t offset
+    ) {
+        std::shared_ptr<ZeroCopySender> sender;
+        {
+            std::scoped_lock queue_lock(queue_mtx_);
+            auto it = queue_.find(socket_id);
+            if (it != queue_.end()) {
+                sender = it->second.zerocopy;
+            }
+        }
+        if (!sender) {
+            throw RuntimeError(
+                "Method: PollManager::SendZeroCopy()"s,
+                "Message: zerocopy is not enabled for socket"s
+            );
+        }
+        // Completions may sit in the error queue while a ONESHOT socket is disarmed,
+        // with none in flight an error there is left to EPOLLERR
+        if (sender->Pending() > 0) {
+            sender->DrainCompletions();
+        }
+        return sender->Send(buffer, offset);
     }
 
-    void PollManager::Remove(const SocketID socket_id) {
-        if (!is_alive_ || is_stoping_) {
+    void PollManager::Route_(const SocketID socket_id, std::uint32_t events) {
+        // Sockets are being handed back, no new work is started
+        if (draining_) {
             return;
         }
 
+        // The error queue raises EPOLLERR next to whatever else is ready,
+        // only an error still pending once it is drained is a real one
+        if (events & EPOLLERR) {
+            std::shared_ptr<ZeroCopySender> sender;
+            bool oneshot = false;
+            {
+                std::scoped_lock queue_lock(queue_mtx_);
+                auto it = queue_.find(socket_id);
+                if (it == queue_.end()) {
+                    return;
+                }
+                sender = it->second.zerocopy;
+                oneshot = (it->second.flags & EPOLLONESHOT);
+            }
+            if (sender) {
+                // A real error taken off the queue with the completions is still one
+                const std::size_t errors = sender->Errors();
+                sender->DrainCompletions();
+                if (sender->Errors() == errors && PendingError(socket_id) == 0) {
+                    events &= ~static_cast<std::uint32_t>(EPOLLERR);
+                }
+            }
+            // Only completions, a ONESHOT socket was disarmed and no handler rearms it
+            if (events == 0) {
+                if (oneshot) {
+                    ResetFlags(socket_id);
+                }
+                return;
+            }
+        }
+
+        bool inline_dispatch = false;
+        std::size_t bound = VSOCK_ANY_WORKER;
+        Priority priority = Priority::NORMAL;
+        std::shared_ptr<socket_stats_t> stats;
+        std::shared_ptr<strand_t> strand;
         {
             std::scoped_lock queue_lock(queue_mtx_);
-
-            if (queue_.find(socket_id) == queue_.end()) {
+            auto it = queue_.find(socket_id);
+            if (it == queue_.end()) {
                 return;
             }
-
-            if (epoll_ctl(epollfd_, EPOLL_CTL_DEL, socket_id, NULL) == -1) {
-                throw RuntimeError(
-                    "Method: PollManager::Remove()"s,
-                    "Message: ::epoll_ctl() failed"s
+            inline_dispatch = it->second.inline_dispatch;
+            stats = it->second.stats;
+            if (profiling_) {
+                // Only the reactor writes event counts
+                stats->events.store(stats->events.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+            if (it->second.closing) {
+                return;
+            }
+            // Hangup goes to the close handler exactly once
+            if (it->second.on_close && (events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR))) {
+                it->second.closing = true;
+                Arm_(socket_id, EPOLLONESHOT);
+                std::shared_ptr<strand_t> serial = it->second.transfer ? nullptr : it->second.strand;
+                // A running strand handler finishes first, the strand closes after it
+                if (serial && (serial->state.fetch_or(events | VSOCK_STRAND_CLOSE | VSOCK_STRAND_RUNNING) & VSOCK_STRAND_RUNNING)) {
+                    return;
+                }
+                ++stats->in_flight;
+                ++in_flight_;
+                Enqueue_(socket_id, Worker_(socket_id, it->second.worker), it->second.priority,
+                    [this, id = socket_id, events, serial = std::move(serial), stats]() {
+                        if (serial) {
+                            RunStrand_(id, serial, stats);
+                        }
+                        else {
+                            Close_(id, events);
+                        }
+                        Release_(stats);
+                    }
                 );
+                return;
             }
+            // Saturated pool: park the socket instead of growing the queue
+            if (!inline_dispatch && Throttle_(socket_id, it->second)) {
+                return;
+            }
+            bound = it->second.worker;
+            priority = it->second.priority;
+            // File transfers take the regular path until they finish
+            if (!it->second.transfer) {
+                strand = it->second.strand;
+            }
+        }
 
-            queue_.erase(socket_id);
+        if (strand) {
+            // Only the first event schedules the strand, later ones are coalesced
+            if (strand->state.fetch_or(events | VSOCK_STRAND_RUNNING) & VSOCK_STRAND_RUNNING) {
+                return;
+            }
+            if (inline_dispatch) {
+                metrics_.Add(Metrics::Counter::INLINE_DISPATCHES);
+                RunStrand_(socket_id, strand, stats);
+                return;
+            }
+            ++stats->in_flight;
+            ++in_flight_;
+            Enqueue_(socket_id, Worker_(socket_id, bound), priority, [this, id = socket_id, strand, stats]() {
+                RunStrand_(id, strand, stats);
+                Release_(stats);
+            });
+            return;
+        }
 
+        if (inline_dispatch) {
+            metrics_.Add(Metrics::Counter::INLINE_DISPATCHES);
+            Dispatch_(socket_id);
+            return;
         }
 
+        ++stats->in_flight;
+        ++in_flight_;
+        Enqueue_(socket_id, Worker_(socket_id, bound), priority, [this, id = socket_id, stats]() {
+            Dispatch_(id);
+            Release_(stats);
+        });
     }
 
-    void PollManager::Start_() {
-        is_alive_ = true;
-
-        (*thread_pool_).AddAsyncTask([this]() {
-            poll_running_ = true;
-            Poll_();
-            std::unique_lock stop_cv_lock(stop_cv_mtx_);
-            poll_running_ = false;
-            stop_cv_.notify_one();
-        });
+    void PollManager::SendFile(
+        const SocketID socket_id,
+        const std::string& path,
+        std::string&& headers,
+        FileTransfer::done_func_t&& done
+    ) {
+        FileCache::file_ptr_t file = file_cache_->Get(path);
+        if (file) {
+            StartTransfer_(
+                socket_id,
+                std::make_shared<FileTransfer>(socket_id, std::move(headers), file),
+                std::move(done)
+            );
+            return;
+        }
 
+        #ifdef _WIN32
+        done(socket_id, false);
+        #else
+        int file_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat st;
+        if (file_fd == -1 || ::fstat(file_fd, &st) == -1) {
+            if (file_fd != -1) {
+                ::close(file_fd);
+            }
+            done(socket_id, false);
+            return;
+        }
+        StartTransfer_(
+            socket_id,
+            std::make_shared<FileTransfer>(
+                socket_id, std::move(headers), file_fd, 0, static_cast<std::uint64_t>(st.st_size), true
+            ),
+            std::move(done)
+        );
+        #endif
     }
 
-    void PollManager::Stop_() {
-        is_stoping_ = true;
-        is_alive_ = false;
-        data_cv_.notify_all();
-        SendAbortSignal_();
+    void PollManager::SendFile(
+        const SocketID socket_id,
+        const int file_fd,
+        const std::uint64_t offset,
+        const std::uint64_t length,
+        std::string&& headers,
+        FileTransfer::done_func_t&& done
+    ) {
+        StartTransfer_(
+            socket_id,
+            std::make_shared<FileTransfer>(socket_id, std::move(headers), file_fd, offset, length, false),
+            std::move(done)
+        );
+    }
 
-        std::unique_lock stop_cv_lock(stop_cv_mtx_);
-        while (poll_running_) {
-            stop_cv_.wait(stop_cv_lock);
+    void PollManager::StartTransfer_(
+        const SocketID socket_id,
+        std::shared_ptr<FileTransfer>&& transfer,
+        FileTransfer::done_func_t&& done
+    ) {
+        {
+            std::scoped_lock queue_lock(queue_mtx_);
+            auto it = queue_.find(socket_id);
+            if (it == queue_.end()) {
+                throw RuntimeError(
+                    "Method: PollManager::StartTransfer_()"s,
+                    "Message: socket is not registered"s
+                );
+            }
+            if (it->second.transfer) {
+                throw RuntimeError(
+                    "Method: PollManager::StartTransfer_()"s,
+                    "Message: transfer is already in progress"s
+                );
+            }
+            // Installed before the first write, a concurrent SendFile() on the
+            // socket fails the check above instead of interleaving its bytes
+            it->second.transfer = transfer;
+            it->second.transfer_done = std::move(done);
+            // The transfer owns the socket, no event may continue it meanwhile
+            Arm_(socket_id, EPOLLONESHOT);
         }
-        stop_cv_lock.unlock();
 
-        ClearPollsAndQueue_();
+        // Most payloads fit into the socket buffer right away
+        ContinueTransfer_(socket_id, transfer);
     }
 
-    void PollManager::Poll_() {
-        std::unique_lock data_cv_lock(data_cv_mtx_);
-        while (is_alive_) {
-            while (queue_.empty() && is_alive_ && !is_stoping_) {
-                data_cv_.wait(data_cv_lock);
+    void PollManager::ContinueTransfer_(const SocketID socket_id, const std::shared_ptr<FileTransfer>& transfer) {
+        const FileTransfer::Status status = transfer->Continue();
+        if (status == FileTransfer::Status::AGAIN) {
+            std::scoped_lock queue_lock(queue_mtx_);
+            auto it = queue_.find(socket_id);
+            if (it != queue_.end() && it->second.transfer == transfer && !it->second.closing) {
+                Arm_(socket_id, TransferEvents(it->second.flags));
             }
+            return;
+        }
 
-            if (!is_alive_ || is_stoping_) {
+        FileTransfer::done_func_t done;
+        {
+            std::scoped_lock queue_lock(queue_mtx_);
+            auto it = queue_.find(socket_id);
+            if (it == queue_.end() || it->second.transfer != transfer) {
                 return;
             }
+            it->second.transfer.reset();
+            done = std::move(it->second.transfer_done);
+        }
+        // Back to the interest the socket was registered with
+        ResetFlags(socket_id);
+        if (done) {
+            done(socket_id, status == FileTransfer::Status::DONE);
+        }
+    }
 
-            int nfds = epoll_wait(epollfd_, epoll_result_, VSOCK_EPOLL_MAX_EVENTS, VSOCK_EPOLL_TIMEOUT);
+    BufferPool& PollManager::Buffers() noexcept {
+        return *buffer_pool_;
+    }
 
-            if (!is_alive_ || is_stoping_) {
-                return;
-            }
+    FileCache& PollManager::Files() noexcept {
+        return *file_cache_;
+    }
 
-            if (nfds == -1) {
-                throw RuntimeError(
-                    "Method: PollManager::Poll_()"s,
-                    "Message: ::epoll_wait() failed"s
-                );
-            }
-            else if (nfds == 0) {
-                continue;
-            }
-            else {
-                for (int n = 0; n < nfds; ++n) {
+    Metrics& PollManager::Stats() noexcept {
+        return metrics_;
+    }
 
-                    SocketID socket_id = epoll_result_[n].data.fd;
+    void PollManager::EnableWatchdog(
+        const std::chrono::milliseconds threshold,
+        Watchdog::report_func_t&& report
+    ) {
+        // A few checks per threshold keep the detection delay small
+        const std::chrono::nanoseconds period = std::max<std::chrono::nanoseconds>(
+            threshold / 4, std::chrono::milliseconds(1)
+        );
+        watchdog_.Start(threshold, period, std::move(report), [this](post_func_t&& job) {
+            Post(std::move(job));
+        });
+    }
 
-                    (*thread_pool_).AddAsyncTask([this, id = socket_id]() {
-                        callback_func_t callback;
-                        bool found = false;
-                        {
-                            std::scoped_lock queue_lock(queue_mtx_);
-                            if (queue_.find(id) != queue_.end()) {
-                                found = true;
-                                callback = queue_.at(id).callback;
-                            }
-                        }
-                        if (found) {
-                            callback(id);
-                        }
-                    });
+    void PollManager::DisableWatchdog() {
+        watchdog_.Stop();
+    }
 
-                }
-            }
+    std::chrono::nanoseconds PollManager::LoopLag() const noexcept {
+        return watchdog_.LoopLag();
+    }
 
-        }
+    void PollManager::SetProfiling(const bool profiling) noexcept {
+        profiling_ = profiling;
     }
 
-    void PollManager::ResetFlags(const SocketID socket_id) {
-        if (!is_alive_ || is_stoping_) {
-            return;
-        }
+    std::vector<PollManager::socket_profile_t> PollManager::TopSockets(const std::size_t count, const ProfileKey key) {
+        std::vector<socket_profile_t> profiles;
         {
             std::scoped_lock queue_lock(queue_mtx_);
-
-            if (queue_.find(socket_id) == queue_.end()) {
-                return;
+            profiles.reserve(queue_.size());
+            for (const auto& [id, value] : queue_) {
+                profiles.push_back({
+                    id,
+                    value.stats->events.load(std::memory_order_relaxed),
+                    value.stats->bytes.load(std::memory_order_relaxed),
+                    std::chrono::nanoseconds(value.stats->cpu_ns.load(std::memory_order_relaxed))
+                });
             }
+        }
 
-            struct epoll_event ev;
-            ev.events = queue_.at(socket_id).flags;
-            ev.data.fd = socket_id;
-            if (epoll_ctl(epollfd_, EPOLL_CTL_MOD, socket_id, &ev) == -1) {
-                throw RuntimeError(
-                    "Method: PollManager::ResetFlags_()"s,
-                    "Message: ::epoll_ctl() failed"s
-                );
+        auto greater = [key](const socket_profile_t& left, const socket_profile_t& right) {
+            switch (key) {
+                case ProfileKey::BYTES: return left.bytes > right.bytes;
+                case ProfileKey::CPU: return left.cpu > right.cpu;
+                default: return left.events > right.events;
             }
-        }
+        };
+        const std::size_t top = std::min(count, profiles.size());
+        std::partial_sort(profiles.begin(), profiles.begin() + top, profiles.end(), greater);
+        profiles.resize(top);
+        return profiles;
     }
 
     void PollManager::CreateEpoll_() {
@@ -211,11 +1400,13 @@ namespace vsock {
         }
 
         CreateAbortEvent_();
+        CreatePostEvent_();
 
     }
 
     void PollManager::DestroyEpoll_() {
 
+        DestroyPostEvent_();
         DestroyAbortEvent_();
 
         #ifdef _WIN32
@@ -252,7 +1443,7 @@ namespace vsock {
         struct epoll_event ev;
         ev.events = (EPOLLIN | EPOLLONESHOT);
         ev.data.fd = abort_event_fd_;
-        if (epoll_ctl(epollfd_, EPOLL_CTL_ADD, abort_event_fd_, &ev) == -1) {
+        if (EpollCtl_(EPOLL_CTL_ADD, abort_event_fd_, &ev) == -1) {
             throw RuntimeError(
                 "Method: PollManager::CreateAbortEvent_()"s,
                 "Message: ::epoll_ctl() failed"s
@@ -263,7 +1454,7 @@ namespace vsock {
 
     void PollManager::DestroyAbortEvent_() {
         #ifndef _WIN32
-        if (epoll_ctl(epollfd_, EPOLL_CTL_DEL, abort_event_fd_, NULL) == VSOCK_EPOLL_ERROR) {
+        if (EpollCtl_(EPOLL_CTL_DEL, abort_event_fd_, NULL) == VSOCK_EPOLL_ERROR) {
             throw RuntimeError(
                 "Method: PollManager::DestroyAbortEvent_()"s,
                 "Message: remove of abort_event_fd_ failed"s
@@ -287,18 +1478,89 @@ namespace vsock {
         #endif        
         }
 
+    void PollManager::CreatePostEvent_() {
+        #ifndef _WIN32
+        post_event_fd_ = eventfd(0, EFD_NONBLOCK);
+        if (post_event_fd_ == VSOCK_EPOLL_ERROR) {
+            throw RuntimeError(
+                "Method: PollManager::CreatePostEvent_()"s,
+                "Message: eventfd() failed"s
+            );
+        }
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = post_event_fd_;
+        if (EpollCtl_(EPOLL_CTL_ADD, post_event_fd_, &ev) == -1) {
+            throw RuntimeError(
+                "Method: PollManager::CreatePostEvent_()"s,
+                "Message: ::epoll_ctl() failed"s
+            );
+        }
+        #endif
+    }
+
+    void PollManager::DestroyPostEvent_() {
+        #ifndef _WIN32
+        if (EpollCtl_(EPOLL_CTL_DEL, post_event_fd_, NULL) == VSOCK_EPOLL_ERROR) {
+            throw RuntimeError(
+                "Method: PollManager::DestroyPostEvent_()"s,
+                "Message: remove of post_event_fd_ failed"s
+            );
+        }
+        close(post_event_fd_);
+        #endif
+        posted_.Clear();
+    }
+
+    void PollManager::SendPostSignal_() {
+        #ifdef _WIN32
+        PostQueuedCompletionStatus(epollfd_, 0, 0, NULL);
+        #else
+        std::uint64_t one = 1;
+        if (::write(post_event_fd_, &one, sizeof(std::uint64_t)) != sizeof(std::uint64_t)) {
+            throw RuntimeError(
+                "Method: PollManager::SendPostSignal_()"s,
+                "Message: ::write() failed"s
+            );
+        }
+        #endif
+    }
+
+    void PollManager::ClearPostSignal_() {
+        #ifndef _WIN32
+        std::uint64_t value = 0;
+        if (::read(post_event_fd_, &value, sizeof(std::uint64_t)) == -1 && errno != EAGAIN) {
+            throw RuntimeError(
+                "Method: PollManager::ClearPostSignal_()"s,
+                "Message: ::read() failed"s
+            );
+        }
+        #endif
+    }
+
     void PollManager::ClearPollsAndQueue_() {
+        // No EPOLL_CTL_DEL per fd, closing the epoll instance drops them all
         for (const auto& [id,value] : queue_) {
-            if (epoll_ctl(epollfd_, EPOLL_CTL_DEL, id, NULL) == -1) {
-                throw RuntimeError(
-                    "Method: PollManager::ClearPollsAndQueue_()"s,
-                    "Message: ::epoll_ctl() failed"s
-                );
+            if (value.ownership == Ownership::OWNED) {
+                CloseFd_(id, value.type);
             }
-            closesocket(id);
         }
         queue_.clear();
     }
 
+    void PollManager::CloseFd_(const SocketID fd, const FdType type) {
+        switch (type) {
+            case FdType::SOCKET:
+            case FdType::UNIX: {
+                closesocket(fd);
+            } break;
+            default: {
+                #ifndef _WIN32
+                ::close(fd);
+                #endif
+            }
+        }
+    }
+
     }
 
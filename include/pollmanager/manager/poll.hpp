@@ -1,8 +1,25 @@
+#ifndef INCLUDE_GUARD_VSOCK_POLL_HPP
+#define INCLUDE_GUARD_VSOCK_POLL_HPP
+
 #include <threadpool/threadpool.hpp>
+#include <pollmanager/buffer/bufferpool.hpp>
+#include <pollmanager/zerocopy/sender.hpp>
+#include <pollmanager/zerocopy/receiver.hpp>
+#include <pollmanager/file/filecache.hpp>
+#include <pollmanager/file/transfer.hpp>
+#include <pollmanager/manager/postqueue.hpp>
+#include <pollmanager/metrics/metrics.hpp>
+#include <pollmanager/manager/watchdog.hpp>
 #include <core/common.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <coroutine>
 #include <cstdint>
-#include <map>
+#include <deque>
+#include <span>
+#include <unordered_map>
+#include <vector>
 #include <functional>
 #include <condition_variable>
 #include <mutex>
@@ -18,33 +35,241 @@ namespace vsock {
         PollManager& operator=(const PollManager&) = delete;
         PollManager& operator=(PollManager&&) = delete;
 
+    public:
+
+        enum class FdType : std::uint8_t {
+            SOCKET,
+            UNIX,
+            EVENT,
+            TIMER,
+            SIGNAL,
+            PIPE,
+            OTHER
+        };
+
+        enum class Ownership : std::uint8_t {
+            OWNED,
+            BORROWED
+        };
+
+        // HIGH for control sockets (listeners, health checks), LOW for bulk
+        using Priority = ThreadPool::Priority;
+
     private:
 
         typedef std::function<void(const SocketID)> callback_func_t;
+        typedef std::function<void(const SocketID, IOBuffer&&)> read_callback_func_t;
+        typedef std::function<void(const SocketID, std::string_view)> view_callback_func_t;
+        typedef PostQueue::job_func_t post_func_t;
+        typedef std::function<void(const SocketID, const std::uint32_t)> close_func_t;
 
+        // Serial executor of one registration: events arriving while the
+        // handler runs are merged into state and replayed once it returns
         typedef struct {
-            std::uint32_t flags;
+            std::atomic<std::uint32_t> state;
+            std::atomic<bool> removed;
             callback_func_t callback;
+        } strand_t;
+
+        // Live counters of one registration, shared with its queued tasks
+        typedef struct {
+            std::atomic<std::size_t> in_flight;
+            std::atomic<std::uint64_t> events;
+            std::atomic<std::uint64_t> bytes;
+            std::atomic<std::uint64_t> cpu_ns;
+        } socket_stats_t;
+
+        // Built with designated initializers, new fields need a default here
+        typedef struct {
+            std::uint32_t flags{ 0 };
+            FdType type{ FdType::OTHER };
+            Ownership ownership{ Ownership::BORROWED };
+            bool inline_dispatch{ false };
+            callback_func_t callback{};
+            std::shared_ptr<strand_t> strand{};
+            std::size_t worker{ VSOCK_ANY_WORKER };
+            bool throttled{ false };
+            std::shared_ptr<socket_stats_t> stats{};
+            Priority priority{ Priority::NORMAL };
+            close_func_t on_close{};
+            bool closing{ false };
+            std::shared_ptr<ZeroCopySender> zerocopy{};
+            std::shared_ptr<FileTransfer> transfer{};
+            FileTransfer::done_func_t transfer_done{};
         } queue_record_t;
 
     public:
 
+        // The fields of AddFd(), defaults match its default arguments
+        typedef struct {
+            SocketID socket_id;
+            std::uint32_t flags;
+            callback_func_t callback;
+            FdType type{ FdType::SOCKET };
+            Ownership ownership{ Ownership::OWNED };
+            bool serial{ false };
+            Priority priority{ Priority::NORMAL };
+            close_func_t on_close{};
+        } registration_t;
+
+        enum class ProfileKey : std::uint8_t {
+            EVENTS,
+            BYTES,
+            CPU
+        };
+
+        typedef struct {
+            SocketID fd;
+            std::uint64_t events;
+            std::uint64_t bytes;
+            std::chrono::nanoseconds cpu;
+        } socket_profile_t;
+
+        class ReadyAwaiter {
+        public:
+
+            ReadyAwaiter(PollManager* const poll, const SocketID fd, const std::uint32_t events);
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle);
+            void await_resume() const noexcept {}
+
+        private:
+
+            PollManager* const poll_;
+            const SocketID fd_;
+            const std::uint32_t events_;
+
+        };
+
         PollManager(ThreadPool* const thread_pool);
+        PollManager(ThreadPool* const thread_pool, BufferPool* const buffer_pool);
         ~PollManager();
 
         void Add(
+            const SocketID socket_id,
+            const std::uint32_t flags,
+            callback_func_t&& callback,
+            const Priority priority = Priority::NORMAL,
+            close_func_t&& on_close = nullptr
+        );
+        bool AddFd(
+            const SocketID fd,
+            const FdType type,
+            const Ownership ownership,
+            const std::uint32_t flags,
+            callback_func_t&& callback,
+            const bool serial = false,
+            const Priority priority = Priority::NORMAL,
+            close_func_t&& on_close = nullptr
+        );
+        void AddSerial(
             const SocketID socket_id,
             const std::uint32_t flags,
             callback_func_t&& callback
         );
+        void AddReader(
+            const SocketID socket_id,
+            const std::uint32_t flags,
+            read_callback_func_t&& callback
+        );
+        void AddZeroCopyReader(
+            const SocketID socket_id,
+            const std::uint32_t flags,
+            view_callback_func_t&& callback
+        );
+        std::size_t AddBatch(std::span<registration_t> registrations);
         void Remove(const SocketID socket_id);
+        std::size_t RemoveBatch(std::span<const SocketID> sockets);
         void ResetFlags(const SocketID socket_id);
+        void Modify(const SocketID socket_id, const std::uint32_t flags);
+
+        void EnableZeroCopy(const SocketID socket_id);
+        std::ptrdiff_t SendZeroCopy(
+            const SocketID socket_id,
+            const ZeroCopySender::shared_buffer_t& buffer,
+            const std::size_t offset = 0
+        );
+
+        void SendFile(
+            const SocketID socket_id,
+            const std::string& path,
+            std::string&& headers,
+            FileTransfer::done_func_t&& done
+        );
+        void SendFile(
+            const SocketID socket_id,
+            const int file_fd,
+            const std::uint64_t offset,
+            const std::uint64_t length,
+            std::string&& headers,
+            FileTransfer::done_func_t&& done
+        );
+
+        void Post(post_func_t&& job);
+        bool Drain(
+            const std::chrono::steady_clock::time_point deadline,
+            std::vector<SocketID>* released = nullptr
+        );
+        void Requeue(const SocketID socket_id);
+        void SetReadBudget(const std::size_t bytes, const std::size_t reads) noexcept;
+
+        void SetInlineDispatch(const SocketID socket_id, const bool inline_dispatch);
+        void SetPriority(const SocketID socket_id, const Priority priority);
+        void SetCloseHandler(const SocketID socket_id, close_func_t&& on_close);
+        void SetAffinity(const bool affinity) noexcept;
+        void SetBackpressure(const std::size_t max_in_flight, const std::size_t max_socket_in_flight) noexcept;
+        std::size_t InFlight() const noexcept;
+        void Bind(const SocketID socket_id, const std::size_t worker);
+        ReadyAwaiter Readable(const SocketID fd);
+        ReadyAwaiter Writable(const SocketID fd);
+
+        BufferPool& Buffers() noexcept;
+        FileCache& Files() noexcept;
+        Metrics& Stats() noexcept;
+
+        void EnableWatchdog(
+            const std::chrono::milliseconds threshold,
+            Watchdog::report_func_t&& report
+        );
+        void DisableWatchdog();
+        std::chrono::nanoseconds LoopLag() const noexcept;
+
+        void SetProfiling(const bool profiling) noexcept;
+        std::vector<socket_profile_t> TopSockets(const std::size_t count, const ProfileKey key);
 
     private:
 
         void Start_();
         void Stop_();
         void Poll_();
+        void Dispatch_(const SocketID socket_id);
+        void Invoke_(const SocketID socket_id, const callback_func_t& callback, socket_stats_t* const stats);
+        void Arm_(const SocketID socket_id, const std::uint32_t events);
+        int EpollCtl_(const int operation, const SocketID fd, struct epoll_event* event);
+        void StartTransfer_(
+            const SocketID socket_id,
+            std::shared_ptr<FileTransfer>&& transfer,
+            FileTransfer::done_func_t&& done
+        );
+        void ContinueTransfer_(const SocketID socket_id, const std::shared_ptr<FileTransfer>& transfer);
+        void Route_(const SocketID socket_id, std::uint32_t events);
+        void RunStrand_(
+            const SocketID socket_id,
+            const std::shared_ptr<strand_t>& strand,
+            const std::shared_ptr<socket_stats_t>& stats
+        );
+        std::size_t Worker_(const SocketID socket_id, const std::size_t bound) const noexcept;
+        void Enqueue_(
+            const SocketID socket_id,
+            const std::size_t worker,
+            const Priority priority,
+            post_func_t&& job
+        );
+        bool Insert_(registration_t&& registration);
+        bool Throttle_(const SocketID socket_id, queue_record_t& record);
+        void Release_(const std::shared_ptr<socket_stats_t>& stats);
+        void ResumeThrottled_();
 
         
 
@@ -53,21 +278,61 @@ namespace vsock {
         void CreateAbortEvent_();
         void DestroyAbortEvent_();
         void SendAbortSignal_();
+        void CreatePostEvent_();
+        void DestroyPostEvent_();
+        void SendPostSignal_();
+        void ClearPostSignal_();
+        void RouteReady_();
+        void Close_(const SocketID socket_id, const std::uint32_t events);
         void ClearPollsAndQueue_();
+        void CloseFd_(const SocketID fd, const FdType type);
 
     private:
 
         EpollID epollfd_;
         ThreadPool* const thread_pool_;
+        BufferPool* const buffer_pool_;
+        FileCache* const file_cache_;
         struct epoll_event* epoll_result_;
 
-        std::map<SocketID, queue_record_t> queue_;
+        std::unordered_map<SocketID, queue_record_t> queue_;
 
-        bool is_alive_;
+        std::atomic<bool> is_alive_;
         bool poll_running_;
-        bool is_stoping_;
+        std::atomic<bool> is_stoping_;
+        std::atomic<bool> draining_;
 
         int abort_event_fd_;
+        int post_event_fd_;
+
+        PostQueue posted_;
+        std::atomic<bool> post_pending_;
+
+        // Sockets that used up their budget, routed again after the next batch
+        std::deque<SocketID> ready_;
+        std::mutex ready_mtx_;
+        std::atomic<bool> ready_pending_;
+        std::atomic<std::size_t> budget_bytes_;
+        std::atomic<std::size_t> budget_reads_;
+
+        std::atomic<bool> affinity_;
+        std::atomic<std::size_t> reactor_worker_;
+
+        // Handlers queued or running in the pool, 0 limits mean unlimited
+        std::atomic<std::size_t> in_flight_;
+        // Release_() calls still past their decrement of in_flight_
+        std::atomic<std::size_t> releasing_;
+        std::atomic<std::size_t> max_in_flight_;
+        std::atomic<std::size_t> max_socket_in_flight_;
+        std::vector<SocketID> throttled_;
+        std::atomic<std::size_t> throttled_count_;
+        std::atomic<bool> resume_posted_;
+        std::mutex drain_mtx_;
+        std::condition_variable drain_cv_;
+
+        Metrics metrics_;
+        Watchdog watchdog_;
+        std::atomic<bool> profiling_;
 
         std::mutex queue_mtx_;
         std::mutex data_cv_mtx_;
@@ -77,4 +342,6 @@ namespace vsock {
 
     };
 
-}
\ No newline at end of file
+}
+
+#endif // INCLUDE_GUARD_VSOCK_POLL_HPP
@@ -0,0 +1,61 @@
+#include <pollmanager/manager/postqueue.hpp>
+
+#include <utility>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // PostQueue class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    PostQueue::PostQueue() :
+        head_{ nullptr }
+    {}
+
+    PostQueue::~PostQueue() {
+        Clear();
+    }
+
+    void PostQueue::Push(job_func_t&& job) {
+        node_t* node = new node_t{ std::move(job), head_.load(std::memory_order_relaxed) };
+        while (!head_.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    std::size_t PostQueue::Run() {
+        node_t* node = TakeAll_();
+        std::size_t count = 0;
+        while (node) {
+            node_t* next = node->next;
+            node->job();
+            delete node;
+            node = next;
+            ++count;
+        }
+        return count;
+    }
+
+    void PostQueue::Clear() noexcept {
+        node_t* node = head_.exchange(nullptr, std::memory_order_acquire);
+        while (node) {
+            delete std::exchange(node, node->next);
+        }
+    }
+
+    bool PostQueue::Empty() const noexcept {
+        return head_.load(std::memory_order_acquire) == nullptr;
+    }
+
+    PostQueue::node_t* PostQueue::TakeAll_() noexcept {
+        node_t* node = head_.exchange(nullptr, std::memory_order_acquire);
+        node_t* reversed = nullptr;
+        while (node) {
+            node_t* next = node->next;
+            node->next = reversed;
+            reversed = node;
+            node = next;
+        }
+        return reversed;
+    }
+
+}
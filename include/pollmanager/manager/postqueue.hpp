@@ -0,0 +1,54 @@
+#ifndef INCLUDE_GUARD_VSOCK_POSTQUEUE_HPP
+#define INCLUDE_GUARD_VSOCK_POSTQUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // PostQueue class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Lock-free multi-producer single-consumer queue of closures. Producers
+    // push onto an intrusive stack, the consumer takes the whole stack at once
+    // and reverses it, so closures run in the order they were posted.
+    class PostQueue {
+    public:
+
+        PostQueue(const PostQueue&) = delete;
+        PostQueue(PostQueue&&) = delete;
+        PostQueue& operator=(const PostQueue&) = delete;
+        PostQueue& operator=(PostQueue&&) = delete;
+
+    public:
+
+        typedef std::function<void(void)> job_func_t;
+
+        PostQueue();
+        ~PostQueue();
+
+        void Push(job_func_t&& job);
+        std::size_t Run();
+        void Clear() noexcept;
+        bool Empty() const noexcept;
+
+    private:
+
+        typedef struct node_t {
+            job_func_t job;
+            node_t* next;
+        } node_t;
+
+        node_t* TakeAll_() noexcept;
+
+    private:
+
+        std::atomic<node_t*> head_;
+
+    };
+
+}
+
+#endif // INCLUDE_GUARD_VSOCK_POSTQUEUE_HPP
@@ -0,0 +1,188 @@
+#include <pollmanager/manager/watchdog.hpp>
+
+#include <new>
+#include <utility>
+
+namespace vsock {
+
+    namespace {
+
+        inline std::uint64_t NowNs() noexcept {
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()
+            ).count());
+        }
+
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Watchdog class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    Watchdog::Watchdog(const std::size_t slots) :
+        running_{ false },
+        threshold_{ 0 },
+        period_{ 0 },
+        report_{},
+        post_{},
+        probe_sent_{ std::make_shared<std::atomic<std::uint64_t>>(0) },
+        probe_reported_{ false },
+        loop_lag_{ 0 }
+    {
+        for (std::size_t i = 0; i < VSOCK_WATCHDOG_CHUNKS; ++i) {
+            chunks_[i] = nullptr;
+        }
+        // The workers known now do not allocate on their first handler
+        for (std::size_t i = 0; i < slots; i += VSOCK_WATCHDOG_CHUNK) {
+            Slot_(i, true);
+        }
+    }
+
+    Watchdog::~Watchdog() {
+        Stop();
+        for (std::size_t i = 0; i < VSOCK_WATCHDOG_CHUNKS; ++i) {
+            delete[] chunks_[i].load();
+        }
+    }
+
+    void Watchdog::Start(
+        const std::chrono::nanoseconds threshold,
+        const std::chrono::nanoseconds period,
+        report_func_t&& report,
+        post_func_t&& post
+    ) {
+        Stop();
+        threshold_ = threshold;
+        period_ = period;
+        report_ = std::move(report);
+        post_ = std::move(post);
+        probe_sent_->store(0);
+        probe_reported_ = false;
+        running_ = true;
+        thread_ = std::thread(&Watchdog::Run_, this);
+    }
+
+    void Watchdog::Stop() {
+        {
+            std::scoped_lock lock(mtx_);
+            if (!running_) {
+                return;
+            }
+            running_ = false;
+        }
+        cv_.notify_all();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    bool Watchdog::Running() const noexcept {
+        return running_.load(std::memory_order_relaxed);
+    }
+
+    void Watchdog::Begin(const std::size_t slot, const SocketID fd, const char* label) noexcept {
+        slot_t* const it = Slot_(slot, true);
+        if (!it) {
+            return;
+        }
+        it->fd.store(fd, std::memory_order_relaxed);
+        it->label.store(label, std::memory_order_relaxed);
+        it->started.store(NowNs(), std::memory_order_release);
+    }
+
+    void Watchdog::End(const std::size_t slot) noexcept {
+        slot_t* const it = Slot_(slot, false);
+        if (!it) {
+            return;
+        }
+        it->started.store(0, std::memory_order_release);
+    }
+
+    std::chrono::nanoseconds Watchdog::LoopLag() const noexcept {
+        return std::chrono::nanoseconds(loop_lag_.load(std::memory_order_relaxed));
+    }
+
+    Watchdog::slot_t* Watchdog::Slot_(const std::size_t slot, const bool allocate) noexcept {
+        // VSOCK_ANY_WORKER and anything past the last chunk is not watched
+        const std::size_t chunk = slot / VSOCK_WATCHDOG_CHUNK;
+        if (chunk >= VSOCK_WATCHDOG_CHUNKS) {
+            return nullptr;
+        }
+        slot_t* slots = chunks_[chunk].load(std::memory_order_acquire);
+        if (!slots && allocate) {
+            slot_t* created = new (std::nothrow) slot_t[VSOCK_WATCHDOG_CHUNK];
+            if (!created) {
+                return nullptr;
+            }
+            for (std::size_t i = 0; i < VSOCK_WATCHDOG_CHUNK; ++i) {
+                created[i].started = 0;
+                created[i].fd = VSOCK_INVALID_SOCKET;
+                created[i].label = nullptr;
+                created[i].reported = 0;
+            }
+            // Two new workers may race for the same chunk, the loser drops its copy
+            if (chunks_[chunk].compare_exchange_strong(slots, created, std::memory_order_acq_rel)) {
+                slots = created;
+            }
+            else {
+                delete[] created;
+            }
+        }
+        return slots ? &slots[slot % VSOCK_WATCHDOG_CHUNK] : nullptr;
+    }
+
+    void Watchdog::Run_() {
+        std::unique_lock lock(mtx_);
+        while (running_) {
+            cv_.wait_for(lock, period_, [this] { return !running_; });
+            if (!running_) {
+                break;
+            }
+            lock.unlock();
+            Check_(NowNs());
+            lock.lock();
+        }
+    }
+
+    void Watchdog::Check_(const std::uint64_t now) {
+        const std::uint64_t threshold = static_cast<std::uint64_t>(threshold_.count());
+
+        // Loop lag is the time a posted closure waits for the reactor
+        const std::uint64_t sent = probe_sent_->load();
+        if (sent == 0) {
+            probe_reported_ = false;
+            probe_sent_->store(now);
+            post_([probe = probe_sent_, lag = &loop_lag_, now]() {
+                lag->store(NowNs() - now, std::memory_order_relaxed);
+                probe->store(0);
+            });
+        }
+        else if (now - sent > threshold && !probe_reported_) {
+            probe_reported_ = true;
+            report_({ VSOCK_INVALID_SOCKET, "reactor", static_cast<std::size_t>(-1), std::chrono::nanoseconds(now - sent) });
+        }
+
+        for (std::size_t c = 0; c < VSOCK_WATCHDOG_CHUNKS; ++c) {
+            slot_t* const chunk = chunks_[c].load(std::memory_order_acquire);
+            if (!chunk) {
+                continue;
+            }
+            for (std::size_t i = 0; i < VSOCK_WATCHDOG_CHUNK; ++i) {
+                slot_t& slot = chunk[i];
+                const std::uint64_t started = slot.started.load(std::memory_order_acquire);
+                if (started == 0 || started == slot.reported || now < started || now - started <= threshold) {
+                    continue;
+                }
+                const SocketID fd = slot.fd.load(std::memory_order_relaxed);
+                const char* label = slot.label.load(std::memory_order_relaxed);
+                // Handler changed while reading the slot, check it next period
+                if (slot.started.load(std::memory_order_acquire) != started) {
+                    continue;
+                }
+                slot.reported = started;
+                report_({ fd, label, c * VSOCK_WATCHDOG_CHUNK + i, std::chrono::nanoseconds(now - started) });
+            }
+        }
+    }
+
+}
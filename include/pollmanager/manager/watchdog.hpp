@@ -0,0 +1,106 @@
+#ifndef INCLUDE_GUARD_VSOCK_WATCHDOG_HPP
+#define INCLUDE_GUARD_VSOCK_WATCHDOG_HPP
+
+#include <core/common.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Worker slots are allocated in chunks the first time a worker needs one
+#define VSOCK_WATCHDOG_CHUNK 64
+#define VSOCK_WATCHDOG_CHUNKS 64
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Watchdog class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Background checker of the event loop. Every worker owns a slot that
+    // holds the handler it is running, a probe posted to the reactor measures
+    // loop lag. Anything running longer than the threshold is reported once.
+    // Slots follow the worker index, workers added by a pool reset get theirs.
+    class Watchdog {
+    public:
+
+        Watchdog() = delete;
+        Watchdog(const Watchdog&) = delete;
+        Watchdog(Watchdog&&) = delete;
+        Watchdog& operator=(const Watchdog&) = delete;
+        Watchdog& operator=(Watchdog&&) = delete;
+
+    public:
+
+        // fd is VSOCK_INVALID_SOCKET when the reactor loop itself is stalled,
+        // label is what the caller said was running on it
+        typedef struct {
+            SocketID fd;
+            const char* label;
+            std::size_t worker;
+            std::chrono::nanoseconds elapsed;
+        } stall_t;
+
+        typedef std::function<void(const stall_t&)> report_func_t;
+        typedef std::function<void(std::function<void(void)>&&)> post_func_t;
+
+        Watchdog(const std::size_t slots);
+        ~Watchdog();
+
+        void Start(
+            const std::chrono::nanoseconds threshold,
+            const std::chrono::nanoseconds period,
+            report_func_t&& report,
+            post_func_t&& post
+        );
+        void Stop();
+        bool Running() const noexcept;
+
+        void Begin(const std::size_t slot, const SocketID fd, const char* label) noexcept;
+        void End(const std::size_t slot) noexcept;
+
+        std::chrono::nanoseconds LoopLag() const noexcept;
+
+    private:
+
+        typedef struct alignas(64) {
+            std::atomic<std::uint64_t> started;
+            std::atomic<SocketID> fd;
+            std::atomic<const char*> label;
+            std::uint64_t reported;
+        } slot_t;
+
+        slot_t* Slot_(const std::size_t slot, const bool allocate) noexcept;
+        void Run_();
+        void Check_(const std::uint64_t now);
+
+    private:
+
+        std::atomic<slot_t*> chunks_[VSOCK_WATCHDOG_CHUNKS];
+
+        std::atomic<bool> running_;
+        std::chrono::nanoseconds threshold_;
+        std::chrono::nanoseconds period_;
+        report_func_t report_;
+        post_func_t post_;
+
+        // Probe in flight, shared with the posted closure
+        std::shared_ptr<std::atomic<std::uint64_t>> probe_sent_;
+        bool probe_reported_;
+        std::atomic<std::uint64_t> loop_lag_;
+
+        std::thread thread_;
+        std::mutex mtx_;
+        std::condition_variable cv_;
+
+    };
+
+}
+
+#endif // INCLUDE_GUARD_VSOCK_WATCHDOG_HPP
@@ -0,0 +1,121 @@
+#include <pollmanager/metrics/metrics.hpp>
+
+#include <bit>
+#include <exception>
+
+namespace vsock {
+
+    namespace {
+
+        // Single writer, a plain load and store avoids the locked add
+        inline void Bump(std::atomic<std::uint64_t>& value, const std::uint64_t delta) noexcept {
+            value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+        }
+
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Metrics class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    Metrics::Metrics() :
+        enabled_{ false },
+        // Counters are cumulative, an adopted shard keeps what it holds
+        shards_{ nullptr, nullptr }
+    {}
+
+    Metrics::~Metrics() {}
+
+    void Metrics::SetEnabled(const bool enabled) noexcept {
+        enabled_.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool Metrics::Enabled() const noexcept {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    void Metrics::Add(const Counter counter, const std::uint64_t value) noexcept {
+        if (!Enabled()) {
+            return;
+        }
+        MetricsShard* shard = LocalShard_();
+        if (!shard) {
+            return;
+        }
+        Bump(shard->counters[static_cast<std::size_t>(counter)], value);
+    }
+
+    void Metrics::Record(const Histogram histogram, const std::uint64_t value) noexcept {
+        if (!Enabled()) {
+            return;
+        }
+        MetricsShard* shard = LocalShard_();
+        if (!shard) {
+            return;
+        }
+        const std::size_t index = static_cast<std::size_t>(histogram);
+        Bump(shard->buckets[index][std::bit_width(value)], 1);
+        Bump(shard->sums[index], value);
+    }
+
+    Metrics::snapshot_t Metrics::Snapshot() {
+        snapshot_t snapshot{};
+        snapshot.taken = std::chrono::steady_clock::now();
+
+        shards_.ForEach([&snapshot](const MetricsShard& shard) {
+            for (std::size_t i = 0; i < COUNTERS_COUNT; ++i) {
+                snapshot.counters[i] += shard.counters[i].load(std::memory_order_relaxed);
+            }
+            for (std::size_t h = 0; h < HISTOGRAMS_COUNT; ++h) {
+                for (std::size_t b = 0; b < BUCKETS_COUNT; ++b) {
+                    snapshot.buckets[h][b] += shard.buckets[h][b].load(std::memory_order_relaxed);
+                }
+                snapshot.sums[h] += shard.sums[h].load(std::memory_order_relaxed);
+            }
+        });
+        return snapshot;
+    }
+
+    std::uint64_t Metrics::Now() noexcept {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count());
+    }
+
+    std::uint64_t Metrics::Count(const snapshot_t& snapshot, const Histogram histogram) noexcept {
+        std::uint64_t count = 0;
+        for (const std::uint64_t bucket : snapshot.buckets[static_cast<std::size_t>(histogram)]) {
+            count += bucket;
+        }
+        return count;
+    }
+
+    std::uint64_t Metrics::Percentile(const snapshot_t& snapshot, const Histogram histogram, const double percentile) noexcept {
+        const std::uint64_t count = Count(snapshot, histogram);
+        if (count == 0) {
+            return 0;
+        }
+        const auto& buckets = snapshot.buckets[static_cast<std::size_t>(histogram)];
+        const std::uint64_t rank = static_cast<std::uint64_t>(percentile / 100.0 * static_cast<double>(count - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (std::size_t b = 0; b < BUCKETS_COUNT; ++b) {
+            seen += buckets[b];
+            if (seen >= rank) {
+                // Upper bound of the bucket
+                return b == 0 ? 0 : (b >= 64 ? UINT64_MAX : (std::uint64_t{ 1 } << b) - 1);
+            }
+        }
+        return UINT64_MAX;
+    }
+
+    MetricsShard* Metrics::LocalShard_() noexcept {
+        // Add() and Record() are noexcept, a failed allocation must not terminate
+        try {
+            return shards_.Local();
+        }
+        catch (const std::exception&) {
+            return nullptr;
+        }
+    }
+
+}
@@ -0,0 +1,102 @@
+#ifndef INCLUDE_GUARD_VSOCK_METRICS_HPP
+#define INCLUDE_GUARD_VSOCK_METRICS_HPP
+
+#include <core/shards.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // MetricsShard struct declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Per-thread counters. Only the owner thread writes them, readers
+    // aggregate with relaxed loads, so the hot path has no locked operations.
+    struct alignas(64) MetricsShard {
+        static constexpr std::size_t COUNTERS_COUNT = 6;
+        static constexpr std::size_t HISTOGRAMS_COUNT = 3;
+        // Bucket b holds values in [2^(b-1), 2^b), bucket 0 holds zero
+        static constexpr std::size_t BUCKETS_COUNT = 65;
+
+        std::array<std::atomic<std::uint64_t>, COUNTERS_COUNT> counters{};
+        std::array<std::array<std::atomic<std::uint64_t>, BUCKETS_COUNT>, HISTOGRAMS_COUNT> buckets{};
+        std::array<std::atomic<std::uint64_t>, HISTOGRAMS_COUNT> sums{};
+    };
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Metrics class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    class Metrics {
+    public:
+
+        Metrics(const Metrics&) = delete;
+        Metrics(Metrics&&) = delete;
+        Metrics& operator=(const Metrics&) = delete;
+        Metrics& operator=(Metrics&&) = delete;
+
+    public:
+
+        static constexpr std::size_t COUNTERS_COUNT = MetricsShard::COUNTERS_COUNT;
+        static constexpr std::size_t HISTOGRAMS_COUNT = MetricsShard::HISTOGRAMS_COUNT;
+        static constexpr std::size_t BUCKETS_COUNT = MetricsShard::BUCKETS_COUNT;
+
+        enum class Counter : std::uint8_t {
+            EPOLL_WAITS,
+            EVENTS,
+            TASKS,
+            INLINE_DISPATCHES,
+            EPOLL_CTLS,
+            THROTTLED
+        };
+
+        // Durations are in nanoseconds
+        enum class Histogram : std::uint8_t {
+            NFDS,
+            QUEUE_DELAY,
+            HANDLER_TIME
+        };
+
+        typedef struct {
+            std::array<std::uint64_t, COUNTERS_COUNT> counters;
+            std::array<std::array<std::uint64_t, BUCKETS_COUNT>, HISTOGRAMS_COUNT> buckets;
+            std::array<std::uint64_t, HISTOGRAMS_COUNT> sums;
+            std::chrono::steady_clock::time_point taken;
+        } snapshot_t;
+
+        Metrics();
+        ~Metrics();
+
+        void SetEnabled(const bool enabled) noexcept;
+        bool Enabled() const noexcept;
+
+        void Add(const Counter counter, const std::uint64_t value = 1) noexcept;
+        void Record(const Histogram histogram, const std::uint64_t value) noexcept;
+
+        snapshot_t Snapshot();
+
+        static std::uint64_t Now() noexcept;
+        static std::uint64_t Count(const snapshot_t& snapshot, const Histogram histogram) noexcept;
+        static std::uint64_t Percentile(const snapshot_t& snapshot, const Histogram histogram, const double percentile) noexcept;
+
+    private:
+
+        // nullptr when the shard could not be created, the sample is dropped
+        MetricsShard* LocalShard_() noexcept;
+
+    private:
+
+        std::atomic<bool> enabled_;
+
+        ShardRegistry<MetricsShard> shards_;
+
+    };
+
+}
+
+#endif // INCLUDE_GUARD_VSOCK_METRICS_HPP
@@ -0,0 +1,222 @@
+#include <pollmanager/relay/relay.hpp>
+#include <core/error.hpp>
+
+#ifdef __linux__
+#include <fcntl.h>
+#endif
+
+#include <utility>
+
+#define VSOCK_RELAY_PIPE_SIZE 65536
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Relay class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    Relay::Relay(PollManager* const poll, const SocketID first, const SocketID second) :
+        poll_{ poll },
+        forward_{ first, second, -1, -1, 0, false, false },
+        backward_{ second, first, -1, -1, 0, false, false },
+        on_close_{},
+        relayed_{ 0 },
+        started_{ false },
+        closed_{ false }
+    {}
+
+    Relay::~Relay() {
+        DestroyPipe_(forward_);
+        DestroyPipe_(backward_);
+    }
+
+    void Relay::Start() {
+        Start(close_func_t());
+    }
+
+    void Relay::Start(close_func_t&& on_close) {
+        #ifndef __linux__
+        throw RuntimeError(
+            "Method: Relay::Start()"s,
+            "Message: splice() relay is available on Linux only"s
+        );
+        #else
+        const std::scoped_lock lock(mtx_);
+        if (started_) {
+            return;
+        }
+
+        for (const SocketID socket_id : { forward_.from, backward_.from }) {
+            const int fl = ::fcntl(socket_id, F_GETFL, 0);
+            if (fl == -1 || ::fcntl(socket_id, F_SETFL, fl | O_NONBLOCK) == -1) {
+                throw RuntimeError(
+                    "Method: Relay::Start()"s,
+                    "Message: ::fcntl() failed"s
+                );
+            }
+        }
+
+        CreatePipe_(forward_);
+        CreatePipe_(backward_);
+        on_close_ = std::move(on_close);
+        started_ = true;
+
+        // Registry keeps the relay alive until both sockets are removed
+        auto self = shared_from_this();
+        for (const SocketID socket_id : { forward_.from, backward_.from }) {
+            // Either side's event pumps both directions
+            poll_->Add(socket_id, (EPOLLIN | EPOLLRDHUP | EPOLLONESHOT), [self](const SocketID) {
+                self->OnEvent_();
+            });
+        }
+        #endif
+    }
+
+    void Relay::Stop() {
+        const std::scoped_lock lock(mtx_);
+        if (!started_ || closed_) {
+            return;
+        }
+        Close_();
+        on_close_ = nullptr;
+    }
+
+    std::size_t Relay::Relayed() const noexcept {
+        return relayed_.load(std::memory_order_relaxed);
+    }
+
+    bool Relay::Closed() const noexcept {
+        const std::scoped_lock lock(mtx_);
+        return closed_;
+    }
+
+    void Relay::OnEvent_() {
+        close_func_t on_close;
+        {
+            const std::scoped_lock lock(mtx_);
+            if (closed_) {
+                return;
+            }
+
+            Pump_(forward_);
+            Pump_(backward_);
+
+            if (forward_.shut && backward_.shut) {
+                Close_();
+                on_close = std::move(on_close_);
+            }
+            else {
+                Rearm_();
+            }
+        }
+        if (on_close) {
+            on_close(forward_.from, backward_.from);
+        }
+    }
+
+    void Relay::Pump_(direction_t& direction) {
+        #ifdef __linux__
+        if (direction.shut) {
+            return;
+        }
+
+        while (!direction.eof && direction.buffered < VSOCK_RELAY_PIPE_SIZE) {
+            ssize_t moved = ::splice(
+                direction.from, nullptr, direction.pipe_write, nullptr,
+                VSOCK_RELAY_PIPE_SIZE - direction.buffered, SPLICE_F_MOVE | SPLICE_F_NONBLOCK
+            );
+            if (moved > 0) {
+                direction.buffered += static_cast<std::size_t>(moved);
+            }
+            else if (moved == 0 || !VSOCK_WOULD_BLOCK()) {
+                direction.eof = true;
+            }
+            else {
+                break;
+            }
+        }
+
+        while (direction.buffered > 0) {
+            ssize_t moved = ::splice(
+                direction.pipe_read, nullptr, direction.to, nullptr,
+                direction.buffered, SPLICE_F_MOVE | SPLICE_F_NONBLOCK
+            );
+            if (moved > 0) {
+                direction.buffered -= static_cast<std::size_t>(moved);
+                relayed_.fetch_add(static_cast<std::size_t>(moved), std::memory_order_relaxed);
+            }
+            else if (VSOCK_WOULD_BLOCK()) {
+                break;
+            }
+            else {
+                // Destination is gone, whatever is left in the pipe is dropped
+                direction.buffered = 0;
+                direction.eof = true;
+            }
+        }
+
+        if (direction.eof && direction.buffered == 0) {
+            ::shutdown(direction.to, SHUT_WR);
+            direction.shut = true;
+        }
+        #endif
+    }
+
+    void Relay::Rearm_() {
+        // Read only while the outgoing pipe has room, write only while the incoming one has data
+        auto interest = [](const direction_t& out, const direction_t& in) {
+            std::uint32_t flags = EPOLLONESHOT;
+            // A half-closed source stays readable and RDHUP, arming it would spin
+            if (!out.eof) {
+                flags |= EPOLLRDHUP;
+                if (out.buffered < VSOCK_RELAY_PIPE_SIZE) {
+                    flags |= EPOLLIN;
+                }
+            }
+            if (in.buffered > 0) {
+                flags |= EPOLLOUT;
+            }
+            return flags;
+        };
+        poll_->Modify(forward_.from, interest(forward_, backward_));
+        poll_->Modify(backward_.from, interest(backward_, forward_));
+    }
+
+    void Relay::Close_() {
+        closed_ = true;
+        poll_->Remove(forward_.from);
+        poll_->Remove(backward_.from);
+        DestroyPipe_(forward_);
+        DestroyPipe_(backward_);
+    }
+
+    void Relay::CreatePipe_(direction_t& direction) {
+        #ifdef __linux__
+        int fds[2];
+        if (::pipe2(fds, O_NONBLOCK | O_CLOEXEC) == -1) {
+            throw RuntimeError(
+                "Method: Relay::CreatePipe_()"s,
+                "Message: ::pipe2() failed"s
+            );
+        }
+        ::fcntl(fds[1], F_SETPIPE_SZ, VSOCK_RELAY_PIPE_SIZE);
+        direction.pipe_read = fds[0];
+        direction.pipe_write = fds[1];
+        #endif
+    }
+
+    void Relay::DestroyPipe_(direction_t& direction) noexcept {
+        #ifdef __linux__
+        if (direction.pipe_read != -1) {
+            ::close(direction.pipe_read);
+            direction.pipe_read = -1;
+        }
+        if (direction.pipe_write != -1) {
+            ::close(direction.pipe_write);
+            direction.pipe_write = -1;
+        }
+        #endif
+        direction.buffered = 0;
+    }
+
+}
@@ -0,0 +1,85 @@
+#ifndef INCLUDE_GUARD_VSOCK_RELAY_HPP
+#define INCLUDE_GUARD_VSOCK_RELAY_HPP
+
+#include <pollmanager/manager/poll.hpp>
+#include <core/common.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // Relay class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Moves bytes between two sockets with splice() through a pipe per
+    // direction, payload never enters user space. A full pipe stops reading
+    // from its source until the destination drains it.
+    class Relay : public std::enable_shared_from_this<Relay> {
+    public:
+
+        Relay() = delete;
+        Relay(const Relay&) = delete;
+        Relay(Relay&&) = delete;
+        Relay& operator=(const Relay&) = delete;
+        Relay& operator=(Relay&&) = delete;
+
+    public:
+
+        typedef std::function<void(const SocketID, const SocketID)> close_func_t;
+
+        Relay(PollManager* const poll, const SocketID first, const SocketID second);
+        ~Relay();
+
+        void Start();
+        void Start(close_func_t&& on_close);
+        void Stop();
+
+        std::size_t Relayed() const noexcept;
+        bool Closed() const noexcept;
+
+    private:
+
+        typedef struct {
+            SocketID from;
+            SocketID to;
+            int pipe_read;
+            int pipe_write;
+            std::size_t buffered;
+            bool eof;
+            bool shut;
+        } direction_t;
+
+        void OnEvent_();
+        void Pump_(direction_t& direction);
+        void Rearm_();
+        void Close_();
+
+        void CreatePipe_(direction_t& direction);
+        void DestroyPipe_(direction_t& direction) noexcept;
+
+    private:
+
+        PollManager* const poll_;
+
+        direction_t forward_;
+        direction_t backward_;
+
+        close_func_t on_close_;
+
+        std::atomic<std::size_t> relayed_;
+        bool started_;
+        bool closed_;
+
+        mutable std::mutex mtx_;
+
+    };
+
+}
+
+#endif // INCLUDE_GUARD_VSOCK_RELAY_HPP
@@ -0,0 +1,115 @@
+#include <pollmanager/zerocopy/receiver.hpp>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <netinet/in.h>
+#include <linux/tcp.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__linux__) && defined(TCP_ZEROCOPY_RECEIVE)
+#define VSOCK_HAS_ZEROCOPY_RECEIVE 1
+#endif
+
+#define VSOCK_ZEROCOPY_MAP_SIZE (2 * 1024 * 1024)
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // ZeroCopyReceiver class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    ZeroCopyReceiver::ZeroCopyReceiver(const SocketID socket_id, BufferPool* const buffer_pool, const std::size_t map_size) :
+        socket_id_{ socket_id },
+        buffer_pool_{ buffer_pool },
+        map_size_{ map_size },
+        map_{ nullptr }
+    {
+        Map_();
+    }
+
+    ZeroCopyReceiver::ZeroCopyReceiver(const SocketID socket_id, BufferPool* const buffer_pool) :
+        ZeroCopyReceiver(socket_id, buffer_pool, VSOCK_ZEROCOPY_MAP_SIZE)
+    {}
+
+    ZeroCopyReceiver::~ZeroCopyReceiver() {
+        Unmap_();
+    }
+
+    std::ptrdiff_t ZeroCopyReceiver::Receive(const view_func_t& handler) {
+        const std::scoped_lock lock(mtx_);
+
+        #ifdef VSOCK_HAS_ZEROCOPY_RECEIVE
+        if (map_) {
+            struct tcp_zerocopy_receive zc {};
+            zc.address = reinterpret_cast<std::uintptr_t>(map_);
+            zc.length = static_cast<std::uint32_t>(map_size_);
+            socklen_t zc_len = sizeof(zc);
+
+            if (::getsockopt(socket_id_, IPPROTO_TCP, TCP_ZEROCOPY_RECEIVE, &zc, &zc_len) == -1) {
+                if (errno == EINVAL || errno == EOPNOTSUPP || errno == ENOPROTOOPT) {
+                    // Not supported for this socket, stay on the copy path for good
+                    Unmap_();
+                }
+                return ReceiveCopy_(handler, VSOCK_READ_BUFFER_SIZE);
+            }
+
+            std::ptrdiff_t total = 0;
+            if (zc.length > 0) {
+                handler(std::string_view(static_cast<const char*>(map_), zc.length));
+                // Drop the pages now, an idle connection should not pin them
+                ::madvise(map_, zc.length, MADV_DONTNEED);
+                total += zc.length;
+            }
+            if (zc.recv_skip_hint > 0) {
+                const std::ptrdiff_t copied = ReceiveCopy_(handler, zc.recv_skip_hint);
+                if (copied > 0) {
+                    total += copied;
+                }
+            }
+            if (total > 0) {
+                return total;
+            }
+        }
+        #endif
+
+        // Nothing mapped: small payload, EOF or would block
+        return ReceiveCopy_(handler, VSOCK_READ_BUFFER_SIZE);
+    }
+
+    bool ZeroCopyReceiver::Mapped() const noexcept {
+        return map_ != nullptr;
+    }
+
+    std::ptrdiff_t ZeroCopyReceiver::ReceiveCopy_(const view_func_t& handler, const std::size_t size) {
+        IOBuffer buffer = buffer_pool_->Acquire(std::min<std::size_t>(size, VSOCK_READ_BUFFER_SIZE));
+        #ifdef _WIN32
+        int received = ::recv(socket_id_, buffer.Data(), static_cast<int>(buffer.Capacity()), 0);
+        #else
+        ssize_t received = ::recv(socket_id_, buffer.Data(), std::min(size, buffer.Capacity()), 0);
+        #endif
+        if (received > 0) {
+            handler(std::string_view(buffer.Data(), static_cast<std::size_t>(received)));
+        }
+        return received;
+    }
+
+    void ZeroCopyReceiver::Map_() {
+        #ifdef VSOCK_HAS_ZEROCOPY_RECEIVE
+        void* map = ::mmap(nullptr, map_size_, PROT_READ, MAP_SHARED, socket_id_, 0);
+        map_ = (map == MAP_FAILED) ? nullptr : map;
+        #endif
+    }
+
+    void ZeroCopyReceiver::Unmap_() noexcept {
+        #ifdef VSOCK_HAS_ZEROCOPY_RECEIVE
+        if (map_) {
+            ::munmap(map_, map_size_);
+        }
+        #endif
+        map_ = nullptr;
+    }
+
+}
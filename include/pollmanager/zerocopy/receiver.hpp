@@ -0,0 +1,63 @@
+#ifndef INCLUDE_GUARD_VSOCK_ZEROCOPY_RECEIVER_HPP
+#define INCLUDE_GUARD_VSOCK_ZEROCOPY_RECEIVER_HPP
+
+#include <pollmanager/buffer/bufferpool.hpp>
+#include <core/common.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string_view>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // ZeroCopyReceiver class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Maps received TCP payload pages straight into a read-only window with
+    // TCP_ZEROCOPY_RECEIVE, the unaligned tail is copied into a pooled buffer.
+    // Views passed to the handler are valid only until it returns.
+    class ZeroCopyReceiver {
+    public:
+
+        ZeroCopyReceiver() = delete;
+        ZeroCopyReceiver(const ZeroCopyReceiver&) = delete;
+        ZeroCopyReceiver(ZeroCopyReceiver&&) = delete;
+        ZeroCopyReceiver& operator=(const ZeroCopyReceiver&) = delete;
+        ZeroCopyReceiver& operator=(ZeroCopyReceiver&&) = delete;
+
+    public:
+
+        typedef std::function<void(std::string_view)> view_func_t;
+
+        ZeroCopyReceiver(const SocketID socket_id, BufferPool* const buffer_pool);
+        ZeroCopyReceiver(const SocketID socket_id, BufferPool* const buffer_pool, const std::size_t map_size);
+        ~ZeroCopyReceiver();
+
+        std::ptrdiff_t Receive(const view_func_t& handler);
+
+        bool Mapped() const noexcept;
+
+    private:
+
+        std::ptrdiff_t ReceiveCopy_(const view_func_t& handler, const std::size_t size);
+
+        void Map_();
+        void Unmap_() noexcept;
+
+    private:
+
+        const SocketID socket_id_;
+        BufferPool* const buffer_pool_;
+        const std::size_t map_size_;
+
+        void* map_;
+
+        std::mutex mtx_;
+
+    };
+
+}
+
+#endif // INCLUDE_GUARD_VSOCK_ZEROCOPY_RECEIVER_HPP
@@ -0,0 +1,167 @@
+#include <pollmanager/zerocopy/sender.hpp>
+
+#ifdef __linux__
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#endif
+
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+
+#ifndef SO_EE_ORIGIN_ZEROCOPY
+#define SO_EE_ORIGIN_ZEROCOPY 5
+#endif
+
+#ifndef SO_EE_CODE_ZEROCOPY_COPIED
+#define SO_EE_CODE_ZEROCOPY_COPIED 1
+#endif
+
+#define VSOCK_ZEROCOPY_THRESHOLD 16384
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // ZeroCopySender class defenition
+    ////////////////////////////////////////////////////////////////////////////////
+
+    ZeroCopySender::ZeroCopySender(const SocketID socket_id, const std::size_t threshold) :
+        socket_id_{ socket_id },
+        threshold_{ threshold },
+        enabled_{ false },
+        next_id_{ 0 },
+        copied_{ 0 },
+        errors_{ 0 },
+        last_error_{ 0 }
+    {
+        Enable_();
+    }
+
+    ZeroCopySender::ZeroCopySender(const SocketID socket_id) :
+        ZeroCopySender(socket_id, VSOCK_ZEROCOPY_THRESHOLD)
+    {}
+
+    std::ptrdiff_t ZeroCopySender::Send(const shared_buffer_t& buffer, const std::size_t offset) {
+        const std::scoped_lock lock(mtx_);
+        const char* data = buffer->Data() + offset;
+        const std::size_t length = buffer->Size() - offset;
+
+        #ifdef _WIN32
+        return ::send(socket_id_, data, static_cast<int>(length), 0);
+        #else
+        if (enabled_ && length >= threshold_) {
+            ssize_t sent = ::send(socket_id_, data, length, MSG_ZEROCOPY | MSG_NOSIGNAL);
+            if (sent > 0) {
+                // Every successful MSG_ZEROCOPY call consumes one completion id
+                in_flight_.emplace_back(next_id_++, buffer);
+                return sent;
+            }
+            if (errno != ENOBUFS) {
+                return sent;
+            }
+            // Out of optmem for notifications, this one goes through a copy
+        }
+        return ::send(socket_id_, data, length, MSG_NOSIGNAL);
+        #endif
+    }
+
+    std::size_t ZeroCopySender::DrainCompletions() {
+        #ifdef _WIN32
+        return 0;
+        #else
+        const std::scoped_lock lock(mtx_);
+        std::size_t released = 0;
+
+        // Drained to the end, an error left behind would keep EPOLLERR raised
+        for (;;) {
+            char control[128];
+            struct msghdr msg {};
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+
+            if (::recvmsg(socket_id_, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) == -1) {
+                break;
+            }
+
+            for (struct cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+                const bool is_recverr =
+                    (cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+                    (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR);
+                if (!is_recverr) {
+                    continue;
+                }
+
+                const struct sock_extended_err* serr = reinterpret_cast<const struct sock_extended_err*>(CMSG_DATA(cm));
+                // Dequeuing it cleared SO_ERROR, the caller learns of it only from here
+                if (serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+                    ++errors_;
+                    last_error_ = static_cast<int>(serr->ee_errno);
+                    continue;
+                }
+                if (serr->ee_errno != 0) {
+                    continue;
+                }
+                if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+                    ++copied_;
+                }
+
+                // Range [ee_info, ee_data] of send calls is done, ids may wrap
+                const std::uint32_t low = serr->ee_info;
+                const std::uint32_t span = serr->ee_data - low;
+                for (auto it = in_flight_.begin(); it != in_flight_.end();) {
+                    if (it->first - low <= span) {
+                        it = in_flight_.erase(it);
+                        ++released;
+                    }
+                    else {
+                        ++it;
+                    }
+                }
+            }
+        }
+
+        return released;
+        #endif
+    }
+
+    std::size_t ZeroCopySender::Pending() const noexcept {
+        const std::scoped_lock lock(mtx_);
+        return in_flight_.size();
+    }
+
+    std::size_t ZeroCopySender::Copied() const noexcept {
+        const std::scoped_lock lock(mtx_);
+        return copied_;
+    }
+
+    std::size_t ZeroCopySender::Errors() const noexcept {
+        const std::scoped_lock lock(mtx_);
+        return errors_;
+    }
+
+    int ZeroCopySender::LastError() const noexcept {
+        const std::scoped_lock lock(mtx_);
+        return last_error_;
+    }
+
+    bool ZeroCopySender::Enabled() const noexcept {
+        return enabled_;
+    }
+
+    void ZeroCopySender::Enable_() {
+        #ifndef _WIN32
+        int one = 1;
+        if (::setsockopt(socket_id_, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == VSOCK_SOCKET_ERROR) {
+            // Kernel or socket type without zerocopy support, plain sends only
+            enabled_ = false;
+            return;
+        }
+        enabled_ = true;
+        #endif
+    }
+
+}
@@ -0,0 +1,70 @@
+#ifndef INCLUDE_GUARD_VSOCK_ZEROCOPY_SENDER_HPP
+#define INCLUDE_GUARD_VSOCK_ZEROCOPY_SENDER_HPP
+
+#include <pollmanager/buffer/bufferpool.hpp>
+#include <core/common.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace vsock {
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // ZeroCopySender class declaration
+    ////////////////////////////////////////////////////////////////////////////////
+
+    // Keeps buffers handed to the kernel with MSG_ZEROCOPY alive until the
+    // completion for their send call arrives on the socket error queue
+    class ZeroCopySender {
+    public:
+
+        ZeroCopySender() = delete;
+        ZeroCopySender(const ZeroCopySender&) = delete;
+        ZeroCopySender(ZeroCopySender&&) = delete;
+        ZeroCopySender& operator=(const ZeroCopySender&) = delete;
+        ZeroCopySender& operator=(ZeroCopySender&&) = delete;
+
+    public:
+
+        typedef std::shared_ptr<const IOBuffer> shared_buffer_t;
+
+        ZeroCopySender(const SocketID socket_id);
+        ZeroCopySender(const SocketID socket_id, const std::size_t threshold);
+
+        std::ptrdiff_t Send(const shared_buffer_t& buffer, const std::size_t offset);
+        std::size_t DrainCompletions();
+
+        std::size_t Pending() const noexcept;
+        std::size_t Copied() const noexcept;
+        // Error queue entries that are not completions, such as ICMP or local errors
+        std::size_t Errors() const noexcept;
+        int LastError() const noexcept;
+        bool Enabled() const noexcept;
+
+    private:
+
+        void Enable_();
+
+    private:
+
+        const SocketID socket_id_;
+        const std::size_t threshold_;
+        bool enabled_;
+
+        std::uint32_t next_id_;
+        std::size_t copied_;
+        std::size_t errors_;
+        int last_error_;
+        std::deque<std::pair<std::uint32_t, shared_buffer_t>> in_flight_;
+
+        mutable std::mutex mtx_;
+
+    };
+
+}
+
+#endif // INCLUDE_GUARD_VSOCK_ZEROCOPY_SENDER_HPP
@@ -21,6 +21,11 @@ namespace vsock {
         return std::deque<std::unique_ptr<Task>>::empty();
     }
 
+    std::size_t TaskQueue::Size() const noexcept {
+        const std::scoped_lock rw_lock(mtx_);
+        return std::deque<std::unique_ptr<Task>>::size();
+    }
+
     void TaskQueue::PopFront(value_t& task) noexcept {
         const std::scoped_lock rw_lock(mtx_);
         task = std::move(std::deque<std::unique_ptr<Task>>::front());
@@ -28,6 +28,7 @@ namespace vsock {
         void PushBack(value_t&& task);
         void Clear() noexcept;
         bool Empty() const noexcept;
+        std::size_t Size() const noexcept;
         void PopFront(value_t& task) noexcept;
 
     private:
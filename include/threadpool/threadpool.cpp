@@ -1,12 +1,22 @@
+#include <algorithm>
 #include <utility>
 #include <threadpool/threadpool.hpp>
+#include <core/trace.hpp>
 
 namespace vsock {
 
+    // Worker identity of the calling thread
+    static thread_local const ThreadPool* current_pool{ nullptr };
+    static thread_local std::size_t current_worker{ VSOCK_ANY_WORKER };
+
     ThreadPool::ThreadPool(const std::size_t concurency, const DestroyType destroy_type) :
         destroy_type_{ destroy_type },
         threads_{ std::make_unique<std::thread[]>(ChooseThreadsCount_(concurency)) },
         tasks_{ },
+        local_tasks_{ },
+        workers_{ },
+        rebalance_limit_{ VSOCK_REBALANCE_LIMIT },
+        steal_after_{ VSOCK_STEAL_AFTER },
         threads_count_{ ChooseThreadsCount_(concurency) },
         tasks_running_{ 0 },
         working_{ false },
@@ -33,7 +43,12 @@ namespace vsock {
     }
 
     void ThreadPool::ClearTasks() noexcept {
-        tasks_.Clear();
+        for (std::size_t priority = 0; priority < VSOCK_PRIORITY_COUNT; ++priority) {
+            tasks_[priority].Clear();
+            for (std::size_t index = 0; index < threads_count_; ++index) {
+                local_tasks_[index][priority].Clear();
+            }
+        }
     }
 
     void ThreadPool::Reset() {
@@ -55,6 +70,18 @@ namespace vsock {
         paused_ = true;
         tasks_lock.unlock();
         Finish_();
+        // Affine tasks left for the old workers go to the shared queues,
+        // the new workers may be fewer and their queues are allocated anew
+        for (std::size_t index = 0; index < threads_count_; ++index) {
+            for (std::size_t priority = 0; priority < VSOCK_PRIORITY_COUNT; ++priority) {
+                TaskQueue& local = local_tasks_[index][priority];
+                while (!local.Empty()) {
+                    std::unique_ptr<Task> task;
+                    local.PopFront(task);
+                    tasks_[priority].PushBack(std::move(task));
+                }
+            }
+        }
         threads_count_ = ChooseThreadsCount_(concurency);
         threads_ = std::make_unique<std::thread[]>(threads_count_);
         CreateThreads_();
@@ -63,13 +90,39 @@ namespace vsock {
     }
 
     void ThreadPool::AddSyncTask(std::unique_ptr<Task> task) {
-        tasks_.PushBack(std::move(task));
-        tasks_available_cv_.notify_one();
+        Push_(VSOCK_ANY_WORKER, Priority::NORMAL, std::move(task));
     }
 
     void ThreadPool::AddAsyncTask(std::unique_ptr<Task> task) {
-        tasks_.PushBack(std::move(task));
-        tasks_available_cv_.notify_one();
+        Push_(VSOCK_ANY_WORKER, Priority::NORMAL, std::move(task));
+    }
+
+    void ThreadPool::AddAffineTask(const std::size_t worker, std::unique_ptr<Task> task) {
+        Push_(worker, Priority::NORMAL, std::move(task));
+    }
+
+    void ThreadPool::AddAffineTask(const std::size_t worker, const Priority priority, std::unique_ptr<Task> task) {
+        Push_(worker, priority, std::move(task));
+    }
+
+    void ThreadPool::AddPriorityTask(const Priority priority, std::unique_ptr<Task> task) {
+        Push_(VSOCK_ANY_WORKER, priority, std::move(task));
+    }
+
+    void ThreadPool::SetRebalanceLimit(const std::size_t limit) noexcept {
+        rebalance_limit_.store(limit, std::memory_order_relaxed);
+    }
+
+    void ThreadPool::SetStealAfter(const std::chrono::microseconds after) noexcept {
+        steal_after_.store(after.count(), std::memory_order_relaxed);
+    }
+
+    std::size_t ThreadPool::ThreadsCount() const noexcept {
+        return threads_count_;
+    }
+
+    std::size_t ThreadPool::CurrentWorker() const noexcept {
+        return current_pool == this ? current_worker : VSOCK_ANY_WORKER;
     }
 
     void ThreadPool::Wait() noexcept {
@@ -77,7 +130,7 @@ namespace vsock {
         waiting_ = true;
         tasks_done_cv_.wait(
             tasks_lock,
-            [this] {return (tasks_running_ == 0) && (paused_ || tasks_.Empty());}
+            [this] {return (tasks_running_ == 0) && (paused_ || TasksEmpty_());}
         );
         waiting_ = false;
     }
@@ -92,7 +145,7 @@ namespace vsock {
             const std::scoped_lock tasks_lock(tasks_mutex_);
             paused_ = false;
         }
-        tasks_available_cv_.notify_all();
+        WakeAll_();
     }
 
     std::size_t ThreadPool::ChooseThreadsCount_(const std::size_t threads_count) const noexcept {
@@ -113,8 +166,10 @@ namespace vsock {
             working_ = true;
         }
 
+        local_tasks_ = std::make_unique<queues_t[]>(threads_count_);
+        workers_ = std::make_unique<worker_t[]>(threads_count_);
         for (std::size_t index = 0; index < threads_count_; ++index) {
-            threads_[index] = std::thread(&ThreadPool::Process_, this);
+            threads_[index] = std::thread(&ThreadPool::Process_, this, index);
         }
 
     }
@@ -124,7 +179,7 @@ namespace vsock {
             const std::scoped_lock tasks_lock(tasks_mutex_);
             working_ = false;
         }
-        tasks_available_cv_.notify_all();
+        WakeAll_();
         for (std::size_t i = 0; i < threads_count_; ++i) {
             threads_[i].join();
         }
@@ -145,34 +200,215 @@ namespace vsock {
         }
     }
 
-    void ThreadPool::Process_() {
+    void ThreadPool::Push_(const std::size_t worker, const Priority priority, std::unique_ptr<Task> task) {
+        const std::size_t level = static_cast<std::size_t>(priority);
+        worker_t* wake = nullptr;
+        {
+            // Workers test for tasks under tasks_mutex_, pushing outside of it
+            // could land between their check and the wait and lose the wakeup
+            const std::scoped_lock tasks_lock(tasks_mutex_);
+            std::size_t owner = VSOCK_ANY_WORKER;
+            bool first_queued = false;
+            if (worker != VSOCK_ANY_WORKER) {
+                TaskQueue& local = local_tasks_[worker % threads_count_][level];
+                // Overloaded worker, let any free thread take the task
+                const std::size_t limit = rebalance_limit_.load(std::memory_order_relaxed);
+                if (limit == 0 || local.Size() < limit) {
+                    local.PushBack(std::move(task));
+                    owner = worker % threads_count_;
+                    first_queued = (local.Size() == 1);
+                }
+            }
+            if (owner != VSOCK_ANY_WORKER) {
+                // Only the owner takes the task unless it stays busy for too long
+                if (workers_[owner].sleeping) {
+                    wake = &workers_[owner];
+                }
+                else if (first_queued && steal_after_.load(std::memory_order_relaxed) > 0) {
+                    // One sleeper times the owner, later pushes find it doing so
+                    for (std::size_t index = 0; index < threads_count_; ++index) {
+                        if (workers_[index].sleeping) {
+                            wake = &workers_[index];
+                            break;
+                        }
+                    }
+                }
+            }
+            else {
+                tasks_[level].PushBack(std::move(task));
+                // Busy workers look at the shared queue before they sleep
+                for (std::size_t index = 0; index < threads_count_; ++index) {
+                    if (workers_[index].sleeping) {
+                        wake = &workers_[index];
+                        break;
+                    }
+                }
+            }
+            // Continue() wakes every worker, a paused one would only sleep again
+            if (paused_) {
+                wake = nullptr;
+            }
+            if (wake) {
+                // A second push must not pick the same worker again
+                wake->sleeping = false;
+            }
+        }
+        if (wake) {
+            wake->cv.notify_one();
+        }
+    }
+
+    void ThreadPool::WakeAll_() noexcept {
+        for (std::size_t index = 0; index < threads_count_; ++index) {
+            workers_[index].cv.notify_one();
+        }
+    }
+
+    TaskQueue* ThreadPool::Next_(const std::size_t index, std::size_t& streak) noexcept {
+        TaskQueue* candidates[VSOCK_PRIORITY_COUNT * 2];
+        for (std::size_t priority = 0; priority < VSOCK_PRIORITY_COUNT; ++priority) {
+            candidates[priority * 2] = &local_tasks_[index][priority];
+            candidates[priority * 2 + 1] = &tasks_[priority];
+        }
+
+        TaskQueue* chosen = nullptr;
+        std::size_t chosen_at = 0;
+        std::size_t lowest_at = 0;
+        for (std::size_t at = 0; at < VSOCK_PRIORITY_COUNT * 2; ++at) {
+            if (candidates[at]->Empty()) {
+                continue;
+            }
+            if (!chosen) {
+                chosen = candidates[at];
+                chosen_at = at;
+            }
+            lowest_at = at;
+        }
+        if (!chosen) {
+            return nullptr;
+        }
+
+        // Nothing waits below the chosen priority
+        if (lowest_at / 2 == chosen_at / 2) {
+            streak = 0;
+            return chosen;
+        }
+        // Anti-starvation: lower priorities get a turn after a streak
+        if (++streak >= VSOCK_PRIORITY_STREAK) {
+            streak = 0;
+            return candidates[lowest_at];
+        }
+        return chosen;
+    }
+
+    TaskQueue* ThreadPool::Steal_(
+        const std::size_t index,
+        std::chrono::steady_clock::time_point& retry
+    ) noexcept {
+        const std::chrono::microseconds after(steal_after_.load(std::memory_order_relaxed));
+        if (after.count() <= 0) {
+            return nullptr;
+        }
+        std::chrono::steady_clock::time_point now{};
+        for (std::size_t owner = 0; owner < threads_count_; ++owner) {
+            if (owner == index || !workers_[owner].busy) {
+                continue;
+            }
+            TaskQueue* queued = nullptr;
+            for (std::size_t priority = 0; priority < VSOCK_PRIORITY_COUNT && !queued; ++priority) {
+                if (!local_tasks_[owner][priority].Empty()) {
+                    queued = &local_tasks_[owner][priority];
+                }
+            }
+            if (!queued) {
+                continue;
+            }
+            // Blocked or running a long task, its affine tasks would starve
+            const std::chrono::steady_clock::time_point stealable = workers_[owner].busy_since + after;
+            if (now == std::chrono::steady_clock::time_point{}) {
+                now = std::chrono::steady_clock::now();
+            }
+            if (now >= stealable) {
+                return queued;
+            }
+            retry = std::min(retry, stealable);
+        }
+        return nullptr;
+    }
+
+    bool ThreadPool::HasTasks_(const std::size_t index) const noexcept {
+        for (std::size_t priority = 0; priority < VSOCK_PRIORITY_COUNT; ++priority) {
+            if (!local_tasks_[index][priority].Empty() || !tasks_[priority].Empty()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool ThreadPool::TasksEmpty_() const noexcept {
+        for (std::size_t priority = 0; priority < VSOCK_PRIORITY_COUNT; ++priority) {
+            if (!tasks_[priority].Empty()) {
+                return false;
+            }
+            for (std::size_t index = 0; index < threads_count_; ++index) {
+                if (!local_tasks_[index][priority].Empty()) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void ThreadPool::Process_(const std::size_t index) {
+        current_pool = this;
+        current_worker = index;
+        std::size_t streak = 0;
+
         std::unique_lock tasks_lock(tasks_mutex_);
         while (true) {
             --tasks_running_;
             tasks_lock.unlock();
-            if (waiting_ && tasks_running_ == 0 && (paused_ || tasks_.Empty())) {
+            if (waiting_ && tasks_running_ == 0 && (paused_ || TasksEmpty_())) {
                 tasks_done_cv_.notify_all();
             }
             tasks_lock.lock();
-            tasks_available_cv_.wait(tasks_lock,
-                [this] {
-                return !(paused_ || tasks_.Empty()) || !working_;
-            });
-            
+            TaskQueue* source = nullptr;
+            while (working_) {
+                std::chrono::steady_clock::time_point retry = std::chrono::steady_clock::time_point::max();
+                if (!paused_) {
+                    source = HasTasks_(index) ? Next_(index, streak) : Steal_(index, retry);
+                    if (source) {
+                        break;
+                    }
+                }
+                workers_[index].sleeping = true;
+                if (retry == std::chrono::steady_clock::time_point::max()) {
+                    workers_[index].cv.wait(tasks_lock);
+                }
+                else {
+                    // An owner holds queued tasks, look again once they may be taken
+                    workers_[index].cv.wait_until(tasks_lock, retry);
+                }
+                workers_[index].sleeping = false;
+            }
+
             if (!working_) {
                 break;
             }
 
             ++tasks_running_;
-            
+            workers_[index].busy = true;
+            workers_[index].busy_since = std::chrono::steady_clock::now();
 
             std::unique_ptr<Task> task;
-            tasks_.PopFront(task);
+            source->PopFront(task);
             tasks_lock.unlock();
+            VSOCK_TRACE(task_pop, index, 0);
             bool not_finished = (*task)();
             tasks_lock.lock();
+            workers_[index].busy = false;
             if (not_finished) {
-                tasks_.PushBack(std::move(task));
+                source->PushBack(std::move(task));
             }
 
         }
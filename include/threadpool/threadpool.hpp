@@ -5,10 +5,23 @@
 #include <mutex>
 #include <deque>
 #include <condition_variable>
+#include <atomic>
+#include <array>
+#include <chrono>
 
 #include <threadpool/task.hpp>
 #include <threadpool/queue.hpp>
 
+// Index returned for threads that are not workers of the pool
+#define VSOCK_ANY_WORKER (static_cast<std::size_t>(-1))
+// Local queue depth above which affine tasks go to the shared queue
+#define VSOCK_REBALANCE_LIMIT 256
+// Microseconds an owner may spend in one task before idle workers take its affine tasks
+#define VSOCK_STEAL_AFTER 5000
+#define VSOCK_PRIORITY_COUNT 3
+// Tasks taken past a waiting lower priority before it is served once
+#define VSOCK_PRIORITY_STREAK 16
+
 namespace vsock {
 
     //////////////////////////////////////////////////////////////////////////////////
@@ -28,6 +41,12 @@ namespace vsock {
             SHARP
         };
 
+        enum class Priority : std::uint8_t {
+            HIGH,
+            NORMAL,
+            LOW
+        };
+
         ThreadPool();
         ThreadPool(const DestroyType destroy_type);
         ThreadPool(const std::size_t concurency);
@@ -46,6 +65,9 @@ namespace vsock {
 
         void AddSyncTask(std::unique_ptr<Task> task);
         void AddAsyncTask(std::unique_ptr<Task> task);
+        void AddAffineTask(const std::size_t worker, std::unique_ptr<Task> task);
+        void AddAffineTask(const std::size_t worker, const Priority priority, std::unique_ptr<Task> task);
+        void AddPriorityTask(const Priority priority, std::unique_ptr<Task> task);
 
         template<typename F, typename...Args>
         auto AddSyncTask(F&& job, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>>;
@@ -53,12 +75,43 @@ namespace vsock {
         template<typename F, typename...Args>
         void AddAsyncTask(F&& job, Args&&... args);
 
+        template<typename F, typename...Args>
+        void AddAffineTask(const std::size_t worker, F&& job, Args&&... args);
+
+        template<typename F, typename...Args>
+        void AddPriorityTask(const Priority priority, F&& job, Args&&... args);
+
+        void SetRebalanceLimit(const std::size_t limit) noexcept;
+        void SetStealAfter(const std::chrono::microseconds after) noexcept;
+        std::size_t ThreadsCount() const noexcept;
+        std::size_t CurrentWorker() const noexcept;
+
+    private:
+
+        typedef std::array<TaskQueue, VSOCK_PRIORITY_COUNT> queues_t;
+
+        // Each worker sleeps on its own condition variable, a push wakes
+        // the one worker that can take the task instead of all of them
+        typedef struct {
+            std::condition_variable cv;
+            bool sleeping;
+            // Set while a task runs, a blocked owner must not strand its queue
+            bool busy;
+            std::chrono::steady_clock::time_point busy_since;
+        } worker_t;
+
     private:
 
         DestroyType destroy_type_;
 
         std::unique_ptr<std::thread[]> threads_;
-        TaskQueue tasks_;
+        // One queue per priority, shared by all workers and local to each
+        // of them. Within a priority a worker serves its own queue first.
+        queues_t tasks_;
+        std::unique_ptr<queues_t[]> local_tasks_;
+        std::unique_ptr<worker_t[]> workers_;
+        std::atomic<std::size_t> rebalance_limit_;
+        std::atomic<std::chrono::microseconds::rep> steal_after_;
 
         std::size_t threads_count_;
         std::size_t tasks_running_;
@@ -69,7 +122,6 @@ namespace vsock {
 
         std::mutex tasks_mutex_;
 
-        std::condition_variable tasks_available_cv_;
         std::condition_variable tasks_done_cv_;
 
         [[nodiscard]] std::size_t ChooseThreadsCount_(const std::size_t threads_count) const noexcept;
@@ -77,7 +129,16 @@ namespace vsock {
         void StopThreads_();
         void DestroyThreads_();
         void Finish_();
-        void Process_();
+        void Process_(const std::size_t index);
+        void Push_(const std::size_t worker, const Priority priority, std::unique_ptr<Task> task);
+        void WakeAll_() noexcept;
+        [[nodiscard]] TaskQueue* Next_(const std::size_t index, std::size_t& streak) noexcept;
+        [[nodiscard]] TaskQueue* Steal_(
+            const std::size_t index,
+            std::chrono::steady_clock::time_point& retry
+        ) noexcept;
+        [[nodiscard]] bool HasTasks_(const std::size_t index) const noexcept;
+        [[nodiscard]] bool TasksEmpty_() const noexcept;
 
     };
 
@@ -89,8 +150,7 @@ namespace vsock {
     auto ThreadPool::AddSyncTask(F&& job, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>> {
         std::unique_ptr<Task> task_ptr(std::make_unique<Task>());
         auto result = task_ptr->SetSyncJob(std::forward<F>(job), std::forward<Args>(args)...);
-        tasks_.PushBack(std::move(task_ptr));
-        tasks_available_cv_.notify_one();
+        Push_(VSOCK_ANY_WORKER, Priority::NORMAL, std::move(task_ptr));
         return result;
     }
 
@@ -98,8 +158,21 @@ namespace vsock {
     void ThreadPool::AddAsyncTask(F&& job, Args&&... args) {
         std::unique_ptr<Task> task_ptr(std::make_unique<Task>());
         task_ptr->SetAsyncJob(std::forward<F>(job), std::forward<Args>(args)...);
-        tasks_.PushBack(std::move(task_ptr));
-        tasks_available_cv_.notify_one();
+        Push_(VSOCK_ANY_WORKER, Priority::NORMAL, std::move(task_ptr));
+    }
+
+    template<typename F, typename...Args>
+    void ThreadPool::AddAffineTask(const std::size_t worker, F&& job, Args&&... args) {
+        std::unique_ptr<Task> task_ptr(std::make_unique<Task>());
+        task_ptr->SetAsyncJob(std::forward<F>(job), std::forward<Args>(args)...);
+        AddAffineTask(worker, std::move(task_ptr));
+    }
+
+    template<typename F, typename...Args>
+    void ThreadPool::AddPriorityTask(const Priority priority, F&& job, Args&&... args) {
+        std::unique_ptr<Task> task_ptr(std::make_unique<Task>());
+        task_ptr->SetAsyncJob(std::forward<F>(job), std::forward<Args>(args)...);
+        Push_(VSOCK_ANY_WORKER, priority, std::move(task_ptr));
     }
 
 }
@@ -0,0 +1,118 @@
+#include <common/test.hpp>
+#include <pollmanager/manager/poll.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+using namespace vsock;
+using namespace vsock::test;
+
+namespace {
+
+    // Blocks freed on another thread go through the remote stack of their owner
+    void RemoteStackIsCapped() {
+        BufferPool pool(4);
+        std::vector<IOBuffer> buffers;
+        std::thread owner([&pool, &buffers]() {
+            for (std::size_t i = 0; i < 100; ++i) {
+                buffers.push_back(pool.Acquire(1024));
+            }
+        });
+        owner.join();
+        VSOCK_CHECK(pool.BlocksAllocated() == 100);
+
+        buffers.clear();
+        VSOCK_CHECK(pool.BlocksAllocated() == 4);
+    }
+
+    void LocalCacheIsCapped() {
+        BufferPool pool(4);
+        std::vector<IOBuffer> buffers;
+        for (std::size_t i = 0; i < 10; ++i) {
+            buffers.push_back(pool.Acquire(256));
+        }
+        buffers.clear();
+        VSOCK_CHECK(pool.BlocksAllocated() == 4);
+
+        // Cached blocks are handed out again instead of new ones
+        for (std::size_t i = 0; i < 4; ++i) {
+            buffers.push_back(pool.Acquire(256));
+        }
+        VSOCK_CHECK(pool.BlocksAllocated() == 4);
+    }
+
+    void ExitedThreadsAreReclaimed() {
+        BufferPool pool(64);
+        for (std::size_t i = 0; i < 50; ++i) {
+            std::thread([&pool]() {
+                IOBuffer buffer = pool.Acquire(4096);
+                buffer.Resize(16);
+            }).join();
+        }
+        // Each thread cached its block, the exit handed it back
+        VSOCK_CHECK(pool.BlocksAllocated() == 0);
+    }
+
+    void BlockOutlivesItsThread() {
+        BufferPool pool(64);
+        IOBuffer buffer;
+        std::thread([&pool, &buffer]() {
+            buffer = pool.Acquire(4096);
+        }).join();
+        // The shard stays valid for blocks still in use after its thread exited
+        VSOCK_CHECK(buffer.Capacity() == 4096);
+        buffer.Release();
+        VSOCK_CHECK(pool.BlocksAllocated() == 1);
+
+        // A new thread adopts the shard together with its remote stack
+        std::thread([&pool]() {
+            IOBuffer again = pool.Acquire(4096);
+        }).join();
+        VSOCK_CHECK(pool.BlocksAllocated() == 0);
+    }
+
+    void ReaderGetsPooledBuffers() {
+        ThreadPool threads(2);
+        BufferPool buffers;
+        std::mutex mtx;
+        std::string received;
+        std::atomic<bool> closed{ false };
+        auto [socket_id, peer_id] = SocketPair();
+        {
+            PollManager poll(&threads, &buffers);
+            poll.AddReader(socket_id, EPOLLIN | EPOLLONESHOT, [&](const SocketID id, IOBuffer&& buffer) {
+                if (!buffer) {
+                    closed = true;
+                    return;
+                }
+                {
+                    const std::scoped_lock lock(mtx);
+                    received.append(buffer.Data(), buffer.Size());
+                }
+                poll.ResetFlags(id);
+            });
+
+            SendAll(peer_id, "hello");
+            VSOCK_CHECK(Eventually([&]() {
+                const std::scoped_lock lock(mtx);
+                return received == "hello";
+            }));
+            closesocket(peer_id);
+            VSOCK_CHECK(Eventually([&]() { return closed.load(); }));
+        }
+        // Every block went back to the pool with the handler done
+        VSOCK_CHECK(buffers.BlocksAllocated() <= buffers.CacheLimit());
+    }
+
+}
+
+int main() {
+    return Run({
+        { "remote_stack_is_capped", RemoteStackIsCapped },
+        { "local_cache_is_capped", LocalCacheIsCapped },
+        { "exited_threads_are_reclaimed", ExitedThreadsAreReclaimed },
+        { "block_outlives_its_thread", BlockOutlivesItsThread },
+        { "reader_gets_pooled_buffers", ReaderGetsPooledBuffers }
+    });
+}
@@ -0,0 +1,147 @@
+#include <common/test.hpp>
+
+#include <csignal>
+#include <cstdio>
+#include <thread>
+#include <netinet/in.h>
+#include <poll.h>
+
+namespace vsock::test {
+
+    ////////////////////////////////////
+    // Helpers
+    //////////////////////////////////
+
+    void Fail(const char* expression, const char* file, const int line) {
+        throw std::runtime_error(std::string(file) + ":"s + std::to_string(line) + ": check failed: "s + expression);
+    }
+
+    int Run(const std::vector<case_t>& cases) {
+        // Peers close under the writer in several cases
+        std::signal(SIGPIPE, SIG_IGN);
+
+        int failed = 0;
+        for (const case_t& each : cases) {
+            try {
+                each.body();
+                std::printf("[ OK ] %s\n", each.name);
+            }
+            catch (const std::exception& error) {
+                std::printf("[FAIL] %s\n%s\n", each.name, error.what());
+                ++failed;
+            }
+            std::fflush(stdout);
+        }
+        return failed == 0 ? 0 : 1;
+    }
+
+    bool Eventually(const std::function<bool()>& predicate, const std::chrono::milliseconds timeout) {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!predicate()) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    std::pair<SocketID, SocketID> SocketPair() {
+        int fds[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) == -1) {
+            throw RuntimeError(
+                "Method: SocketPair()"s,
+                "Message: ::socketpair() failed"s
+            );
+        }
+        SetNonBlocking(fds[0]);
+        return { fds[0], fds[1] };
+    }
+
+    std::pair<SocketID, SocketID> TcpPair() {
+        const SocketID listen_id = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        struct sockaddr_in address {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        if (listen_id == VSOCK_INVALID_SOCKET ||
+            ::bind(listen_id, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == -1 ||
+            ::listen(listen_id, 1) == -1 ||
+            ::getsockname(listen_id, reinterpret_cast<struct sockaddr*>(&address), &length) == -1) {
+            throw RuntimeError(
+                "Method: TcpPair()"s,
+                "Message: loopback listener failed"s
+            );
+        }
+        const SocketID client_id = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (::connect(client_id, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == -1) {
+            throw RuntimeError(
+                "Method: TcpPair()"s,
+                "Message: ::connect() failed"s
+            );
+        }
+        const SocketID server_id = ::accept(listen_id, nullptr, nullptr);
+        closesocket(listen_id);
+        if (server_id == VSOCK_INVALID_SOCKET) {
+            throw RuntimeError(
+                "Method: TcpPair()"s,
+                "Message: ::accept() failed"s
+            );
+        }
+        SetNonBlocking(server_id);
+        return { server_id, client_id };
+    }
+
+    void SetNonBlocking(const SocketID socket_id) {
+        const int flags = ::fcntl(socket_id, F_GETFL, 0);
+        if (flags == -1 || ::fcntl(socket_id, F_SETFL, flags | O_NONBLOCK) == -1) {
+            throw RuntimeError(
+                "Method: SetNonBlocking()"s,
+                "Message: ::fcntl() failed"s
+            );
+        }
+    }
+
+    void SendAll(const SocketID socket_id, const std::string& data) {
+        std::size_t sent = 0;
+        while (sent < data.size()) {
+            const ssize_t result = ::send(socket_id, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (result > 0) {
+                sent += static_cast<std::size_t>(result);
+                continue;
+            }
+            if (result == VSOCK_SOCKET_ERROR && VSOCK_WOULD_BLOCK()) {
+                struct pollfd pfd { socket_id, POLLOUT, 0 };
+                ::poll(&pfd, 1, 100);
+                continue;
+            }
+            throw RuntimeError(
+                "Method: SendAll()"s,
+                "Message: ::send() failed"s
+            );
+        }
+    }
+
+    std::string RecvAll(const SocketID socket_id, const std::size_t size) {
+        std::string data(size, '\0');
+        std::size_t received = 0;
+        // A lost reply fails the case after a while instead of hanging it
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (received < size && std::chrono::steady_clock::now() < deadline) {
+            const ssize_t result = ::recv(socket_id, data.data() + received, size - received, MSG_DONTWAIT);
+            if (result > 0) {
+                received += static_cast<std::size_t>(result);
+                continue;
+            }
+            if (result == VSOCK_SOCKET_ERROR && VSOCK_WOULD_BLOCK()) {
+                struct pollfd pfd { socket_id, POLLIN, 0 };
+                ::poll(&pfd, 1, 100);
+                continue;
+            }
+            break;
+        }
+        data.resize(received);
+        return data;
+    }
+
+}
@@ -0,0 +1,53 @@
+#ifndef INCLUDE_GUARD_VSOCK_TEST_HPP
+#define INCLUDE_GUARD_VSOCK_TEST_HPP
+
+#include <core/common.hpp>
+#include <core/error.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Fails the running case with the expression and where it was checked.
+// Only for the test thread, handlers record into atomics that it checks.
+#define VSOCK_CHECK(expression) \
+    ((expression) ? (void)0 : vsock::test::Fail(#expression, __FILE__, __LINE__))
+
+namespace vsock::test {
+
+    typedef struct {
+        const char* name;
+        std::function<void()> body;
+    } case_t;
+
+    ////////////////////////////////////
+    // Helpers
+    //////////////////////////////////
+
+    [[noreturn]] void Fail(const char* expression, const char* file, const int line);
+
+    // Runs every case and prints one line each, the result is the exit code
+    int Run(const std::vector<case_t>& cases);
+
+    // Polls the predicate until it holds, handlers run on other threads
+    bool Eventually(
+        const std::function<bool()>& predicate,
+        const std::chrono::milliseconds timeout = std::chrono::seconds(5)
+    );
+
+    // Connected AF_UNIX stream pair, the first socket is non-blocking
+    std::pair<SocketID, SocketID> SocketPair();
+    // Connected loopback TCP pair, the first socket is non-blocking
+    std::pair<SocketID, SocketID> TcpPair();
+
+    void SetNonBlocking(const SocketID socket_id);
+    void SendAll(const SocketID socket_id, const std::string& data);
+    // Reads exactly size bytes, shorter when the peer closes or on timeout
+    std::string RecvAll(const SocketID socket_id, const std::size_t size);
+
+}
+
+#endif // INCLUDE_GUARD_VSOCK_TEST_HPP
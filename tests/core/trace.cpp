@@ -0,0 +1,54 @@
+#include <common/test.hpp>
+#include <pollmanager/manager/poll.hpp>
+#include <core/trace.hpp>
+
+#include <atomic>
+#include <cstring>
+
+using namespace vsock;
+using namespace vsock::test;
+
+namespace {
+
+    std::atomic<std::uint64_t> enqueued_socket{ 0 };
+    std::atomic<std::size_t> hook_calls{ 0 };
+
+    void Hook(const char* probe, const std::uint64_t arg0, const std::uint64_t) {
+        ++hook_calls;
+        if (std::strcmp(probe, "enqueue") == 0) {
+            enqueued_socket = arg0;
+        }
+    }
+
+    // The enqueue probe reports the socket, compiled out the hook never runs
+    void EnqueueProbeReportsSocket() {
+        ThreadPool threads(2);
+        auto [socket_id, peer_id] = SocketPair();
+        std::atomic<bool> handled{ false };
+        SetTraceHook(Hook);
+        {
+            PollManager poll(&threads);
+            poll.Add(socket_id, EPOLLIN | EPOLLONESHOT, [&](const SocketID id) {
+                char data[8];
+                while (::recv(id, data, sizeof(data), 0) > 0) {}
+                handled = true;
+            });
+            SendAll(peer_id, "x");
+            VSOCK_CHECK(Eventually([&]() { return handled.load(); }));
+        }
+        SetTraceHook(nullptr);
+        #if defined(VSOCK_TRACEPOINTS) && !defined(VSOCK_TRACE_SDT)
+        VSOCK_CHECK(enqueued_socket == static_cast<std::uint64_t>(socket_id));
+        #elif !defined(VSOCK_TRACEPOINTS)
+        VSOCK_CHECK(hook_calls == 0);
+        #endif
+        closesocket(peer_id);
+    }
+
+}
+
+int main() {
+    return Run({
+        { "enqueue_probe_reports_socket", EnqueueProbeReportsSocket }
+    });
+}
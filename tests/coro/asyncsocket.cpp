@@ -0,0 +1,122 @@
+#include <common/test.hpp>
+#include <pollmanager/coro/asyncsocket.hpp>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace vsock;
+using namespace vsock::test;
+
+namespace {
+
+    CoTask<void> Echo(AsyncSocket& socket, std::atomic<std::size_t>& echoed, std::atomic<bool>& finished) {
+        std::vector<char> data(65536);
+        while (true) {
+            const std::ptrdiff_t received = co_await socket.Read(data.data(), data.size());
+            if (received <= 0) {
+                break;
+            }
+            const std::ptrdiff_t sent = co_await socket.Write(data.data(), static_cast<std::size_t>(received));
+            if (sent != received) {
+                break;
+            }
+            echoed += static_cast<std::size_t>(sent);
+        }
+        finished = true;
+    }
+
+    CoTask<void> AwaitReadable(PollManager& poll, const SocketID fd, std::string& error, std::atomic<bool>& finished) {
+        try {
+            co_await poll.Readable(fd);
+        }
+        catch (const RuntimeError& e) {
+            error = e.what();
+        }
+        finished = true;
+    }
+
+    // More than both socket buffers, reads and writes have to suspend in turn
+    void EchoRoundTrip(const bool inline_resume) {
+        ThreadPool threads(2);
+        auto [socket_id, peer_id] = SocketPair();
+        std::atomic<std::size_t> echoed{ 0 };
+        std::atomic<bool> finished{ false };
+
+        std::string payload(1024 * 1024, '\0');
+        for (std::size_t i = 0; i < payload.size(); ++i) {
+            payload[i] = static_cast<char>(i * 31);
+        }
+        {
+            PollManager poll(&threads);
+            AsyncSocket socket(&poll, socket_id, inline_resume);
+            Spawn(Echo(socket, echoed, finished));
+
+            std::thread writer([&]() {
+                SendAll(peer_id, payload);
+                ::shutdown(peer_id, SHUT_WR);
+            });
+            const std::string received = RecvAll(peer_id, payload.size());
+            writer.join();
+
+            VSOCK_CHECK(received == payload);
+            VSOCK_CHECK(Eventually([&]() { return finished.load(); }));
+            VSOCK_CHECK(echoed == payload.size());
+        }
+        closesocket(peer_id);
+    }
+
+    // A draining manager refuses the fd, the error has to say so
+    void AwaitDuringDrainReportsDrain() {
+        ThreadPool threads(2);
+        auto [busy_id, busy_peer] = SocketPair();
+        auto [idle_id, idle_peer] = SocketPair();
+        std::atomic<bool> blocked{ false };
+        std::atomic<bool> release{ false };
+        std::atomic<bool> finished{ false };
+        std::string error;
+        {
+            PollManager poll(&threads);
+            poll.Add(busy_id, EPOLLIN | EPOLLONESHOT, [&](const SocketID) {
+                blocked = true;
+                while (!release) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            });
+            SendAll(busy_peer, "x");
+            VSOCK_CHECK(Eventually([&]() { return blocked.load(); }));
+
+            // The running handler holds Drain() until it is released
+            std::thread drainer([&poll]() {
+                poll.Drain(std::chrono::steady_clock::now() + std::chrono::seconds(5));
+            });
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            Spawn(AwaitReadable(poll, idle_id, error, finished));
+            VSOCK_CHECK(Eventually([&]() { return finished.load(); }));
+            release = true;
+            drainer.join();
+            VSOCK_CHECK(error.find("draining or stopping") != std::string::npos);
+        }
+        closesocket(busy_peer);
+        closesocket(idle_id);
+        closesocket(idle_peer);
+    }
+
+    void WorkerResume() {
+        EchoRoundTrip(false);
+    }
+
+    void InlineResume() {
+        EchoRoundTrip(true);
+    }
+
+}
+
+int main() {
+    return Run({
+        { "worker_resume", WorkerResume },
+        { "inline_resume", InlineResume },
+        { "await_during_drain_reports_drain", AwaitDuringDrainReportsDrain }
+    });
+}
@@ -0,0 +1,109 @@
+#include <common/test.hpp>
+#include <pollmanager/datagram/endpoint.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include <netinet/in.h>
+
+using namespace vsock;
+using namespace vsock::test;
+
+namespace {
+
+    // Bound loopback UDP socket, the address is where its peer sends to
+    SocketID UdpSocket(struct sockaddr_in& address) {
+        const SocketID socket_id = ::socket(AF_INET, SOCK_DGRAM, 0);
+        VSOCK_CHECK(socket_id != VSOCK_INVALID_SOCKET);
+        address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        VSOCK_CHECK(::bind(socket_id, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == 0);
+        VSOCK_CHECK(::getsockname(socket_id, reinterpret_cast<struct sockaddr*>(&address), &length) == 0);
+        SetNonBlocking(socket_id);
+        return socket_id;
+    }
+
+    void SendTo(const SocketID socket_id, const struct sockaddr_in& address, const std::string& data) {
+        VSOCK_CHECK(::sendto(
+            socket_id, data.data(), data.size(), 0,
+            reinterpret_cast<const struct sockaddr*>(&address), sizeof(address)
+        ) == static_cast<ssize_t>(data.size()));
+    }
+
+    // Larger than a receive buffer, the datagram is dropped and counted
+    void TruncatedDatagramsAreDropped() {
+        ThreadPool threads(2);
+        struct sockaddr_in address;
+        struct sockaddr_in peer_address;
+        const SocketID socket_id = UdpSocket(address);
+        const SocketID peer_id = UdpSocket(peer_address);
+        std::mutex mtx;
+        std::vector<std::string> received;
+        {
+            PollManager poll(&threads);
+            auto endpoint = std::make_shared<DatagramEndpoint>(&poll, socket_id);
+            endpoint->Start([&](const DatagramEndpoint::datagram_t* datagrams, const std::size_t count) {
+                const std::scoped_lock lock(mtx);
+                for (std::size_t i = 0; i < count; ++i) {
+                    received.emplace_back(datagrams[i].data);
+                }
+            });
+
+            SendTo(peer_id, address, "small");
+            SendTo(peer_id, address, std::string(16384, 'x'));
+            SendTo(peer_id, address, "after");
+            VSOCK_CHECK(Eventually([&]() {
+                return endpoint->Received() + endpoint->Truncated() == 3;
+            }));
+            VSOCK_CHECK(endpoint->Truncated() == 1);
+            const std::scoped_lock lock(mtx);
+            VSOCK_CHECK(received == std::vector<std::string>({ "small", "after" }));
+            endpoint->Stop();
+        }
+        closesocket(socket_id);
+        closesocket(peer_id);
+    }
+
+    // With room for it, a datagram past the default buffer size comes through whole
+    void LargerBuffersKeepLargeDatagrams() {
+        ThreadPool threads(2);
+        struct sockaddr_in address;
+        struct sockaddr_in peer_address;
+        const SocketID socket_id = UdpSocket(address);
+        const SocketID peer_id = UdpSocket(peer_address);
+        const std::string large(9000, 'j');
+        std::mutex mtx;
+        std::vector<std::string> received;
+        {
+            PollManager poll(&threads);
+            auto endpoint = std::make_shared<DatagramEndpoint>(&poll, socket_id, 8, 16384);
+            endpoint->Start([&](const DatagramEndpoint::datagram_t* datagrams, const std::size_t count) {
+                const std::scoped_lock lock(mtx);
+                for (std::size_t i = 0; i < count; ++i) {
+                    received.emplace_back(datagrams[i].data);
+                }
+            });
+
+            SendTo(peer_id, address, large);
+            SendTo(peer_id, address, "after");
+            VSOCK_CHECK(Eventually([&]() { return endpoint->Received() == 2; }));
+            VSOCK_CHECK(endpoint->Truncated() == 0);
+            const std::scoped_lock lock(mtx);
+            VSOCK_CHECK(received == std::vector<std::string>({ large, "after" }));
+            endpoint->Stop();
+        }
+        closesocket(socket_id);
+        closesocket(peer_id);
+    }
+
+}
+
+int main() {
+    return Run({
+        { "truncated_datagrams_are_dropped", TruncatedDatagramsAreDropped },
+        { "larger_buffers_keep_large_datagrams", LargerBuffersKeepLargeDatagrams }
+    });
+}
@@ -0,0 +1,61 @@
+#include <common/test.hpp>
+#include <pollmanager/fd/eventcounter.hpp>
+#include <pollmanager/manager/poll.hpp>
+
+#include <atomic>
+
+using namespace vsock;
+using namespace vsock::test;
+
+namespace {
+
+    // Notifications add up until a take resets the counter
+    void CounterAccumulatesAndResets() {
+        EventCounter counter;
+        VSOCK_CHECK(counter.Take() == 0);
+        counter.Notify(2);
+        counter.Notify(3);
+        VSOCK_CHECK(counter.Take() == 5);
+        VSOCK_CHECK(counter.Take() == 0);
+    }
+
+    // A semaphore hands out one per take
+    void SemaphoreTakesOne() {
+        EventCounter counter(true);
+        counter.Notify(3);
+        for (std::size_t i = 0; i < 3; ++i) {
+            VSOCK_CHECK(counter.Take() == 1);
+        }
+        VSOCK_CHECK(counter.Take() == 0);
+    }
+
+    // Registered as borrowed, every notification reaches the handler
+    void NotifiesThroughPollManager() {
+        ThreadPool threads(2);
+        EventCounter counter;
+        std::atomic<std::uint64_t> taken{ 0 };
+        {
+            PollManager poll(&threads);
+            poll.AddFd(
+                counter.Fd(), PollManager::FdType::EVENT, PollManager::Ownership::BORROWED, EPOLLIN | EPOLLONESHOT,
+                [&](const SocketID id) {
+                    taken += counter.Take();
+                    poll.ResetFlags(id);
+                }
+            );
+            for (std::uint64_t i = 1; i <= 4; ++i) {
+                counter.Notify(i);
+                VSOCK_CHECK(Eventually([&]() { return taken == i * (i + 1) / 2; }));
+            }
+        }
+    }
+
+}
+
+int main() {
+    return Run({
+        { "counter_accumulates_and_resets", CounterAccumulatesAndResets },
+        { "semaphore_takes_one", SemaphoreTakesOne },
+        { "notifies_through_poll_manager", NotifiesThroughPollManager }
+    });
+}
@@ -0,0 +1,84 @@
+#include <common/test.hpp>
+#include <pollmanager/fd/signalreceiver.hpp>
+
+#include <atomic>
+#include <csignal>
+#include <thread>
+
+#include <unistd.h>
+
+using namespace vsock;
+using namespace vsock::test;
+
+namespace {
+
+    // Runs a thread that idles until the check is done
+    class Idler {
+    public:
+
+        Idler() : running_{ false }, stop_{ false }, thread_{ [this]() {
+            running_ = true;
+            while (!stop_) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        } } {
+            // A starting thread blocks everything until it runs with the inherited mask
+            while (!running_) {
+                std::this_thread::yield();
+            }
+        }
+
+        ~Idler() {
+            stop_ = true;
+            thread_.join();
+        }
+
+    private:
+
+        std::atomic<bool> running_;
+        std::atomic<bool> stop_;
+        std::thread thread_;
+
+    };
+
+    // Single threaded, the mask of the calling thread is the process mask
+    void ReceivesSignals() {
+        SignalReceiver receiver({ SIGUSR1 });
+        VSOCK_CHECK(::kill(::getpid(), SIGUSR1) == 0);
+        int signal = 0;
+        VSOCK_CHECK(Eventually([&]() { return (signal = receiver.Take()) != 0; }));
+        VSOCK_CHECK(signal == SIGUSR1);
+    }
+
+    // The running thread would take the signal instead of the signalfd
+    void UnblockedThreadIsRefused() {
+        Idler idler;
+        bool thrown = false;
+        try {
+            SignalReceiver receiver({ SIGUSR2 });
+        }
+        catch (const RuntimeError&) {
+            thrown = true;
+        }
+        VSOCK_CHECK(thrown);
+    }
+
+    void BlockBeforeThreadsStart() {
+        SignalReceiver::Block({ SIGTERM });
+        Idler idler;
+        SignalReceiver receiver({ SIGTERM });
+        VSOCK_CHECK(::kill(::getpid(), SIGTERM) == 0);
+        int signal = 0;
+        VSOCK_CHECK(Eventually([&]() { return (signal = receiver.Take()) != 0; }));
+        VSOCK_CHECK(signal == SIGTERM);
+    }
+
+}
+
+int main() {
+    return Run({
+        { "receives_signals", ReceivesSignals },
+        { "unblocked_thread_is_refused", UnblockedThreadIsRefused },
+        { "block_before_threads_start", BlockBeforeThreadsStart }
+    });
+}
@@ -0,0 +1,64 @@
+#include <common/test.hpp>
+#include <pollmanager/fd/timer.hpp>
+#include <pollmanager/manager/poll.hpp>
+
+#include <atomic>
+#include <thread>
+
+using namespace vsock;
+using namespace vsock::test;
+
+namespace {
+
+    void Register(PollManager& poll, Timer& timer, std::atomic<std::uint64_t>& expirations) {
+        poll.AddFd(
+            timer.Fd(), PollManager::FdType::TIMER, PollManager::Ownership::BORROWED, EPOLLIN | EPOLLONESHOT,
+            [&poll, &timer, &expirations](const SocketID id) {
+                expirations += timer.Take();
+                poll.ResetFlags(id);
+            }
+        );
+    }
+
+    // A zero interval expires once and stays quiet
+    void OneShotExpiresOnce() {
+        ThreadPool threads(2);
+        Timer timer;
+        std::atomic<std::uint64_t> expirations{ 0 };
+        {
+            PollManager poll(&threads);
+            Register(poll, timer, expirations);
+            timer.Arm(std::chrono::milliseconds(20), std::chrono::nanoseconds(0));
+            VSOCK_CHECK(Eventually([&]() { return expirations == 1; }));
+            std::this_thread::sleep_for(std::chrono::milliseconds(60));
+            VSOCK_CHECK(expirations == 1);
+        }
+    }
+
+    // Expirations keep coming until the timer is disarmed
+    void PeriodicExpiresUntilDisarmed() {
+        ThreadPool threads(2);
+        Timer timer;
+        std::atomic<std::uint64_t> expirations{ 0 };
+        {
+            PollManager poll(&threads);
+            Register(poll, timer, expirations);
+            timer.Arm(std::chrono::milliseconds(5), std::chrono::milliseconds(5));
+            VSOCK_CHECK(Eventually([&]() { return expirations >= 3; }));
+            timer.Disarm();
+            // A handler may still be taking what expired before the disarm
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            const std::uint64_t disarmed = expirations;
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            VSOCK_CHECK(expirations == disarmed);
+        }
+    }
+
+}
+
+int main() {
+    return Run({
+        { "one_shot_expires_once", OneShotExpiresOnce },
+        { "periodic_expires_until_disarmed", PeriodicExpiresUntilDisarmed }
+    });
+}
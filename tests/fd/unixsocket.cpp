@@ -0,0 +1,95 @@
+#include <common/test.hpp>
+#include <pollmanager/fd/unixsocket.hpp>
+
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace vsock;
+using namespace vsock::test;
+
+namespace {
+
+    // A socket left behind by an earlier listener is replaced
+    void StaleSocketIsReplaced() {
+        const std::string path = "/tmp/vsock_unixsocket_stale";
+        ::unlink(path.c_str());
+        SocketID listen_id = UnixSocket::Listen(path, 4);
+        closesocket(listen_id);
+
+        listen_id = UnixSocket::Listen(path, 4);
+        const SocketID client_id = UnixSocket::Connect(path);
+        VSOCK_CHECK(Eventually([&]() {
+            const SocketID accepted = UnixSocket::Accept(listen_id);
+            if (accepted == VSOCK_INVALID_SOCKET) {
+                return false;
+            }
+            closesocket(accepted);
+            return true;
+        }));
+        closesocket(client_id);
+        closesocket(listen_id);
+        ::unlink(path.c_str());
+    }
+
+    // A listening server keeps its address, the second listener is refused
+    void LiveSocketIsKept() {
+        const std::string path = "/tmp/vsock_unixsocket_live";
+        ::unlink(path.c_str());
+        const SocketID listen_id = UnixSocket::Listen(path, 4);
+
+        bool thrown = false;
+        try {
+            UnixSocket::Listen(path, 4);
+        }
+        catch (const RuntimeError&) {
+            thrown = (errno == EADDRINUSE);
+        }
+        VSOCK_CHECK(thrown);
+
+        // The probe is queued like any client, both reach the first listener
+        const SocketID client_id = UnixSocket::Connect(path);
+        std::size_t accepted = 0;
+        VSOCK_CHECK(Eventually([&]() {
+            const SocketID accepted_id = UnixSocket::Accept(listen_id);
+            if (accepted_id != VSOCK_INVALID_SOCKET) {
+                closesocket(accepted_id);
+                ++accepted;
+            }
+            return accepted == 2;
+        }));
+        closesocket(client_id);
+        closesocket(listen_id);
+        ::unlink(path.c_str());
+    }
+
+    void RegularFileIsKept() {
+        const std::string path = "/tmp/vsock_unixsocket_file";
+        const int file_fd = ::open(path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0600);
+        VSOCK_CHECK(file_fd != -1);
+        ::close(file_fd);
+
+        bool thrown = false;
+        try {
+            UnixSocket::Listen(path, 4);
+        }
+        catch (const RuntimeError&) {
+            thrown = true;
+        }
+        VSOCK_CHECK(thrown);
+        struct stat st;
+        VSOCK_CHECK(::lstat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode));
+        ::unlink(path.c_str());
+    }
+
+}
+
+int main() {
+    return Run({
+        { "stale_socket_is_replaced", StaleSocketIsReplaced },
+        { "live_socket_is_kept", LiveSocketIsKept },
+        { "regular_file_is_kept", RegularFileIsKept }
+    });
+}
@@ -0,0 +1,185 @@
+#include <common/test.hpp>
+#include <pollmanager/manager/poll.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace vsock;
+using namespace vsock::test;
+
+namespace {
+
+    std::string TempFile(const std::string& content) {
+        char path[] = "/tmp/vsock_sendfile_XXXXXX";
+        const int file_fd = ::mkstemp(path);
+        VSOCK_CHECK(file_fd != -1);
+        VSOCK_CHECK(::write(file_fd, content.data(), content.size()) == static_cast<ssize_t>(content.size()));
+        ::close(file_fd);
+        return path;
+    }
+
+    // Replaced by rename(), an old mapping keeps showing the old content
+    void Replace(const std::string& path, const std::string& content) {
+        const std::string replacement = TempFile(content);
+        VSOCK_CHECK(::rename(replacement.c_str(), path.c_str()) == 0);
+    }
+
+    void SendsHeadersAndFile() {
+        ThreadPool threads(2);
+        auto [socket_id, peer_id] = SocketPair();
+        const std::string path = TempFile("cached body");
+        std::atomic<int> result{ -1 };
+        {
+            PollManager poll(&threads);
+            poll.Add(socket_id, EPOLLIN | EPOLLONESHOT, [](const SocketID) {});
+            poll.SendFile(socket_id, path, "head:", [&result](const SocketID, const bool ok) {
+                result = ok;
+            });
+            VSOCK_CHECK(RecvAll(peer_id, 16) == "head:cached body");
+            VSOCK_CHECK(Eventually([&]() { return result == 1; }));
+        }
+        ::unlink(path.c_str());
+        closesocket(peer_id);
+    }
+
+    // Same size and within the same second, only the nanoseconds tell them apart
+    void SameSecondRewriteIsNotStale() {
+        FileCache cache;
+        const std::string path = TempFile("first");
+        FileCache::file_ptr_t file = cache.Get(path);
+        VSOCK_CHECK(file && std::string(file->Data(), file->Size()) == "first");
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        Replace(path, "again");
+        file = cache.Get(path);
+        VSOCK_CHECK(file && std::string(file->Data(), file->Size()) == "again");
+        ::unlink(path.c_str());
+    }
+
+    // A file stat() accepts but open() refuses ends in done(false), not a throw
+    void UnreadableFileReportsFailure() {
+        ThreadPool threads(2);
+        auto [socket_id, peer_id] = SocketPair();
+        const std::string path = TempFile("secret");
+        VSOCK_CHECK(::chmod(path.c_str(), 0) == 0);
+        std::atomic<int> result{ -1 };
+        {
+            PollManager poll(&threads);
+            poll.Add(socket_id, EPOLLIN | EPOLLONESHOT, [](const SocketID) {});
+            // Root ignores the mode, drop the effective user for the call
+            const uid_t user = ::geteuid();
+            const bool dropped = (user == 0 && ::seteuid(65534) == 0);
+            bool thrown = false;
+            try {
+                poll.SendFile(socket_id, path, "", [&result](const SocketID, const bool ok) {
+                    result = ok;
+                });
+            }
+            catch (const RuntimeError&) {
+                thrown = true;
+            }
+            if (dropped) {
+                VSOCK_CHECK(::seteuid(user) == 0);
+            }
+            VSOCK_CHECK(!thrown);
+            if (user != 0 || dropped) {
+                VSOCK_CHECK(result == 0);
+            }
+        }
+        ::unlink(path.c_str());
+        closesocket(peer_id);
+    }
+
+    // Larger than the socket buffer, the first transfer is still running
+    // when the second one starts and the second one must be refused
+    void ConcurrentTransfersAreRefused() {
+        ThreadPool threads(2);
+        const std::string body(4 * 1024 * 1024, 'f');
+        const std::string path = TempFile(body);
+        for (std::size_t round = 0; round < 10; ++round) {
+            auto [socket_id, peer_id] = SocketPair();
+            std::atomic<std::size_t> started{ 0 };
+            std::atomic<std::size_t> refused{ 0 };
+            std::atomic<std::size_t> succeeded{ 0 };
+            {
+                PollManager poll(&threads);
+                poll.Add(socket_id, EPOLLIN | EPOLLONESHOT, [](const SocketID) {});
+                auto send = [&]() {
+                    ++started;
+                    while (started < 2) {
+                        std::this_thread::yield();
+                    }
+                    try {
+                        poll.SendFile(socket_id, path, "", [&succeeded](const SocketID, const bool ok) {
+                            succeeded += ok;
+                        });
+                    }
+                    catch (const RuntimeError&) {
+                        ++refused;
+                    }
+                };
+                std::thread first(send);
+                std::thread second(send);
+                first.join();
+                second.join();
+                VSOCK_CHECK(refused == 1);
+
+                VSOCK_CHECK(RecvAll(peer_id, body.size()) == body);
+                VSOCK_CHECK(Eventually([&]() { return succeeded == 1; }));
+                char data[1];
+                VSOCK_CHECK(::recv(peer_id, data, sizeof(data), MSG_DONTWAIT) == -1);
+            }
+            closesocket(peer_id);
+        }
+        ::unlink(path.c_str());
+    }
+
+    // The peer hangs up mid-transfer, the close handler hears it and the
+    // transfer reports the failure instead of waiting for EPOLLOUT forever
+    void HangupEndsTransfer() {
+        ThreadPool threads(2);
+        auto [socket_id, peer_id] = TcpPair();
+        const std::string path = TempFile(std::string(4 * 1024 * 1024, 'h'));
+        const int small = 16 * 1024;
+        ::setsockopt(socket_id, SOL_SOCKET, SO_SNDBUF, &small, sizeof(small));
+        ::setsockopt(peer_id, SOL_SOCKET, SO_RCVBUF, &small, sizeof(small));
+        std::atomic<int> result{ -1 };
+        std::atomic<bool> closed{ false };
+        {
+            PollManager poll(&threads);
+            poll.Add(
+                socket_id, EPOLLIN | EPOLLONESHOT, [](const SocketID) {}, PollManager::Priority::NORMAL,
+                [&closed](const SocketID, const std::uint32_t) { closed = true; }
+            );
+            poll.SendFile(socket_id, path, "", [&result](const SocketID, const bool ok) {
+                result = ok;
+            });
+            // The peer reads nothing, the transfer stalls on a full buffer
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            VSOCK_CHECK(result == -1);
+
+            // Only RDHUP reports a half-close, HUP needs both directions down
+            ::shutdown(peer_id, SHUT_WR);
+            VSOCK_CHECK(Eventually([&]() { return closed.load(); }));
+            VSOCK_CHECK(Eventually([&]() { return result == 0; }));
+        }
+        ::unlink(path.c_str());
+        closesocket(peer_id);
+    }
+
+}
+
+int main() {
+    return Run({
+        { "sends_headers_and_file", SendsHeadersAndFile },
+        { "same_second_rewrite_is_not_stale", SameSecondRewriteIsNotStale },
+        { "unreadable_file_reports_failure", UnreadableFileReportsFailure },
+        { "concurrent_transfers_are_refused", ConcurrentTransfersAreRefused },
+        { "hangup_ends_transfer", HangupEndsTransfer }
+    });
+}
@@ -0,0 +1,163 @@
+#include <common/test.hpp>
+#include <pollmanager/manager/poll.hpp>
+#include <core/error.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace vsock;
+using namespace vsock::test;
+
+namespace {
+
+    // Posted jobs run on the reactor, so does the worker they report
+    std::size_t ReactorWorker(PollManager& poll, ThreadPool& threads) {
+        std::atomic<std::size_t> reactor{ VSOCK_ANY_WORKER };
+        poll.Post([&]() { reactor = threads.CurrentWorker(); });
+        VSOCK_CHECK(Eventually([&]() { return reactor != VSOCK_ANY_WORKER; }));
+        return reactor;
+    }
+
+    // Every event of a socket lands on one worker, which is not the reactor's
+    void SocketStaysOnOneWorker() {
+        ThreadPool threads(4);
+        std::vector<std::pair<SocketID, SocketID>> pairs;
+        for (std::size_t i = 0; i < 3; ++i) {
+            pairs.push_back(SocketPair());
+        }
+        std::mutex mtx;
+        std::vector<std::set<std::size_t>> workers(pairs.size());
+        std::vector<std::atomic<std::size_t>> calls(pairs.size());
+        {
+            PollManager poll(&threads);
+            poll.SetAffinity(true);
+            // Level-triggered events would pile up past the rebalance limit
+            for (std::size_t i = 0; i < pairs.size(); ++i) {
+                poll.Add(pairs[i].first, EPOLLIN | EPOLLONESHOT, [&, i](const SocketID id) {
+                    char data[8];
+                    while (::recv(id, data, sizeof(data), 0) > 0) {}
+                    {
+                        const std::scoped_lock lock(mtx);
+                        workers[i].insert(threads.CurrentWorker());
+                    }
+                    ++calls[i];
+                    poll.ResetFlags(id);
+                });
+            }
+            const std::size_t reactor = ReactorWorker(poll, threads);
+
+            for (std::size_t round = 0; round < 10; ++round) {
+                for (std::size_t i = 0; i < pairs.size(); ++i) {
+                    SendAll(pairs[i].second, "x");
+                    VSOCK_CHECK(Eventually([&]() { return calls[i] == round + 1; }));
+                }
+            }
+
+            const std::scoped_lock lock(mtx);
+            for (const std::set<std::size_t>& used : workers) {
+                VSOCK_CHECK(used.size() == 1);
+                VSOCK_CHECK(*used.begin() != reactor);
+            }
+        }
+        for (const auto& pair : pairs) {
+            closesocket(pair.second);
+        }
+    }
+
+    // Bind() takes a ThreadPool::CurrentWorker() index as it is
+    void BindRunsOnThatWorker() {
+        ThreadPool threads(4);
+        std::vector<std::pair<SocketID, SocketID>> pairs;
+        for (std::size_t i = 0; i < threads.ThreadsCount(); ++i) {
+            pairs.push_back(SocketPair());
+        }
+        std::vector<std::atomic<std::size_t>> ran_on(pairs.size());
+        for (std::atomic<std::size_t>& worker : ran_on) {
+            worker = VSOCK_ANY_WORKER;
+        }
+        {
+            PollManager poll(&threads);
+            for (std::size_t i = 0; i < pairs.size(); ++i) {
+                poll.Add(pairs[i].first, EPOLLIN | EPOLLONESHOT, [&, i](const SocketID id) {
+                    char data[8];
+                    while (::recv(id, data, sizeof(data), 0) > 0) {}
+                    ran_on[i] = threads.CurrentWorker();
+                });
+            }
+            const std::size_t reactor = ReactorWorker(poll, threads);
+
+            for (std::size_t worker = 0; worker < pairs.size(); ++worker) {
+                if (worker == reactor) {
+                    bool thrown = false;
+                    try {
+                        poll.Bind(pairs[worker].first, worker);
+                    }
+                    catch (const RuntimeError&) {
+                        thrown = true;
+                    }
+                    VSOCK_CHECK(thrown);
+                    continue;
+                }
+                poll.Bind(pairs[worker].first, worker);
+                SendAll(pairs[worker].second, "x");
+                VSOCK_CHECK(Eventually([&]() { return ran_on[worker] != VSOCK_ANY_WORKER; }));
+                VSOCK_CHECK(ran_on[worker] == worker);
+            }
+
+            bool thrown = false;
+            try {
+                poll.Bind(pairs[0].first, threads.ThreadsCount());
+            }
+            catch (const RuntimeError&) {
+                thrown = true;
+            }
+            VSOCK_CHECK(thrown);
+        }
+        for (const auto& pair : pairs) {
+            closesocket(pair.second);
+        }
+    }
+
+    // The bound worker is stuck in another task, an idle one serves the socket
+    void BusyWorkerDoesNotStrandSocket() {
+        ThreadPool threads(3);
+        auto [socket_id, peer_id] = SocketPair();
+        std::atomic<bool> blocked{ false };
+        std::atomic<bool> release{ false };
+        std::atomic<bool> handled{ false };
+        {
+            PollManager poll(&threads);
+            poll.Add(socket_id, EPOLLIN | EPOLLONESHOT, [&](const SocketID id) {
+                char data[8];
+                while (::recv(id, data, sizeof(data), 0) > 0) {}
+                handled = true;
+            });
+            const std::size_t worker = (ReactorWorker(poll, threads) + 1) % threads.ThreadsCount();
+            poll.Bind(socket_id, worker);
+            threads.AddAffineTask(worker, [&]() {
+                blocked = true;
+                while (!release) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            });
+            VSOCK_CHECK(Eventually([&]() { return blocked.load(); }));
+
+            SendAll(peer_id, "x");
+            VSOCK_CHECK(Eventually([&]() { return handled.load(); }));
+            release = true;
+        }
+        closesocket(peer_id);
+    }
+
+}
+
+int main() {
+    return Run({
+        { "socket_stays_on_one_worker", SocketStaysOnOneWorker },
+        { "bind_runs_on_that_worker", BindRunsOnThatWorker },
+        { "busy_worker_does_not_strand_socket", BusyWorkerDoesNotStrandSocket }
+    });
+}
@@ -0,0 +1,114 @@
+#include <common/test.hpp>
+#include <pollmanager/manager/poll.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace vsock;
+using namespace vsock::test;
+
+namespace {
+
+    // Handlers block, the reactor parks the sockets above the global limit
+    // and rearms them once the pool has drained below half of it
+    void InFlightStaysUnderLimit() {
+        ThreadPool threads(6);
+        std::vector<std::pair<SocketID, SocketID>> pairs;
+        for (std::size_t i = 0; i < 6; ++i) {
+            pairs.push_back(SocketPair());
+        }
+        std::atomic<bool> release{ false };
+        std::atomic<std::size_t> active{ 0 };
+        std::atomic<std::size_t> peak{ 0 };
+        std::atomic<std::size_t> handled{ 0 };
+        {
+            PollManager poll(&threads);
+            poll.Stats().SetEnabled(true);
+            poll.SetBackpressure(2, 0);
+            for (const auto& pair : pairs) {
+                poll.AddFd(
+                    pair.first, PollManager::FdType::SOCKET, PollManager::Ownership::BORROWED, EPOLLIN | EPOLLONESHOT,
+                    [&](const SocketID id) {
+                        const std::size_t now = ++active;
+                        std::size_t seen = peak;
+                        while (now > seen && !peak.compare_exchange_weak(seen, now)) {}
+                        while (!release) {
+                            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                        }
+                        char data[8];
+                        while (::recv(id, data, sizeof(data), 0) > 0) {}
+                        --active;
+                        ++handled;
+                    }
+                );
+            }
+            for (const auto& pair : pairs) {
+                SendAll(pair.second, "x");
+            }
+
+            VSOCK_CHECK(Eventually([&]() { return active == 2; }));
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            VSOCK_CHECK(active == 2);
+            VSOCK_CHECK(poll.InFlight() == 2);
+            const Metrics::snapshot_t snapshot = poll.Stats().Snapshot();
+            VSOCK_CHECK(snapshot.counters[static_cast<std::size_t>(Metrics::Counter::THROTTLED)] > 0);
+
+            release = true;
+            VSOCK_CHECK(Eventually([&]() { return handled == 6; }));
+            VSOCK_CHECK(peak == 2);
+            VSOCK_CHECK(Eventually([&]() { return poll.InFlight() == 0; }));
+        }
+        for (const auto& pair : pairs) {
+            closesocket(pair.first);
+            closesocket(pair.second);
+        }
+    }
+
+    // A socket over its own limit is parked while the others keep going
+    void SocketLimitParksOnlyThatSocket() {
+        ThreadPool threads(4);
+        auto [busy_id, busy_peer] = SocketPair();
+        auto [free_id, free_peer] = SocketPair();
+        std::atomic<bool> release{ false };
+        std::atomic<std::size_t> busy_runs{ 0 };
+        std::atomic<std::size_t> free_runs{ 0 };
+        {
+            PollManager poll(&threads);
+            poll.SetBackpressure(0, 1);
+            // Level-triggered, every batch reports the busy socket again
+            poll.AddFd(busy_id, PollManager::FdType::SOCKET, PollManager::Ownership::BORROWED, EPOLLIN, [&](const SocketID id) {
+                ++busy_runs;
+                while (!release) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                char data[8];
+                while (::recv(id, data, sizeof(data), 0) > 0) {}
+            });
+            poll.AddFd(free_id, PollManager::FdType::SOCKET, PollManager::Ownership::BORROWED, EPOLLIN, [&](const SocketID id) {
+                char data[8];
+                while (::recv(id, data, sizeof(data), 0) > 0) {}
+                ++free_runs;
+            });
+
+            SendAll(busy_peer, "x");
+            VSOCK_CHECK(Eventually([&]() { return busy_runs == 1; }));
+            SendAll(free_peer, "y");
+            VSOCK_CHECK(Eventually([&]() { return free_runs == 1; }));
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            VSOCK_CHECK(busy_runs == 1);
+            release = true;
+        }
+        for (const SocketID socket_id : { busy_id, busy_peer, free_id, free_peer }) {
+            closesocket(socket_id);
+        }
+    }
+
+}
+
+int main() {
+    return Run({
+        { "in_flight_stays_under_limit", InFlightStaysUnderLimit },
+        { "socket_limit_parks_only_that_socket", SocketLimitParksOnlyThatSocket }
+    });
+}
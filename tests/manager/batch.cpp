@@ -0,0 +1,169 @@
+#include <common/test.hpp>
+#include <pollmanager/manager/poll.hpp>
+#include <core/error.hpp>
+
+#include <atomic>
+#include <fcntl.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace vsock;
+using namespace vsock::test;
+
+namespace {
+
+    // Priority reaches the pool the same way it does through Add()
+    void BatchKeepsPriority() {
+        ThreadPool threads(2);
+        auto [low_id, low_peer] = SocketPair();
+        auto [high_id, high_peer] = SocketPair();
+        std::atomic<bool> blocked{ false };
+        std::atomic<bool> release{ false };
+        std::mutex mtx;
+        std::vector<SocketID> order;
+        {
+            PollManager poll(&threads);
+            auto handler = [&](const SocketID id) {
+                char data[8];
+                while (::recv(id, data, sizeof(data), 0) > 0) {}
+                const std::scoped_lock lock(mtx);
+                order.push_back(id);
+            };
+            std::vector<PollManager::registration_t> registrations;
+            registrations.push_back({ .socket_id = low_id, .flags = EPOLLIN | EPOLLONESHOT, .callback = handler,
+                .priority = PollManager::Priority::LOW });
+            registrations.push_back({ .socket_id = high_id, .flags = EPOLLIN | EPOLLONESHOT, .callback = handler,
+                .priority = PollManager::Priority::HIGH });
+            VSOCK_CHECK(poll.AddBatch(registrations) == 2);
+            threads.AddAsyncTask([&blocked, &release]() {
+                blocked = true;
+                while (!release) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            });
+            // Queued behind it, the handlers would overtake the blocker
+            VSOCK_CHECK(Eventually([&]() { return blocked.load(); }));
+
+            SendAll(low_peer, "low");
+            SendAll(high_peer, "high");
+            VSOCK_CHECK(Eventually([&]() { return poll.InFlight() == 2; }));
+            release = true;
+            VSOCK_CHECK(Eventually([&]() {
+                const std::scoped_lock lock(mtx);
+                return order.size() == 2;
+            }));
+            VSOCK_CHECK(order == std::vector<SocketID>({ high_id, low_id }));
+        }
+        closesocket(low_peer);
+        closesocket(high_peer);
+    }
+
+    // The close handler fires and a borrowed socket is left open
+    void BatchKeepsCloseHandlerAndOwnership() {
+        ThreadPool threads(2);
+        auto [socket_id, peer_id] = SocketPair();
+        std::atomic<bool> closed{ false };
+        {
+            PollManager poll(&threads);
+            std::vector<PollManager::registration_t> registrations;
+            registrations.push_back({
+                .socket_id = socket_id,
+                .flags = EPOLLIN,
+                .callback = [](const SocketID id) {
+                    char data[8];
+                    while (::recv(id, data, sizeof(data), 0) > 0) {}
+                },
+                .ownership = PollManager::Ownership::BORROWED,
+                .on_close = [&closed](const SocketID, const std::uint32_t) { closed = true; }
+            });
+            VSOCK_CHECK(poll.AddBatch(registrations) == 1);
+
+            closesocket(peer_id);
+            VSOCK_CHECK(Eventually([&]() { return closed.load(); }));
+        }
+        VSOCK_CHECK(::fcntl(socket_id, F_GETFD) != -1);
+        closesocket(socket_id);
+    }
+
+    // A refused fd is reported, the valid ones are still registered
+    void BatchReportsFailureAndKeepsTheRest() {
+        ThreadPool threads(2);
+        auto [socket_id, peer_id] = SocketPair();
+        std::atomic<std::size_t> calls{ 0 };
+        {
+            PollManager poll(&threads);
+            std::vector<PollManager::registration_t> registrations;
+            registrations.push_back({ .socket_id = -1, .flags = EPOLLIN, .callback = [](const SocketID) {} });
+            registrations.push_back({
+                .socket_id = socket_id,
+                .flags = EPOLLIN | EPOLLONESHOT,
+                .callback = [&calls](const SocketID id) {
+                    char data[8];
+                    while (::recv(id, data, sizeof(data), 0) > 0) {}
+                    ++calls;
+                }
+            });
+
+            bool thrown = false;
+            try {
+                poll.AddBatch(registrations);
+            }
+            catch (const RuntimeError&) {
+                thrown = true;
+            }
+            VSOCK_CHECK(thrown);
+
+            SendAll(peer_id, "x");
+            VSOCK_CHECK(Eventually([&]() { return calls == 1; }));
+        }
+        closesocket(peer_id);
+    }
+
+    // Same as Remove(): an epoll failure throws, the other sockets still go
+    void RemoveBatchReportsFailure() {
+        ThreadPool threads(2);
+        auto [closed_id, closed_peer] = SocketPair();
+        auto [socket_id, peer_id] = SocketPair();
+        std::atomic<std::size_t> calls{ 0 };
+        {
+            PollManager poll(&threads);
+            auto handler = [&calls](const SocketID id) {
+                char data[8];
+                while (::recv(id, data, sizeof(data), 0) > 0) {}
+                ++calls;
+            };
+            poll.AddFd(closed_id, PollManager::FdType::SOCKET, PollManager::Ownership::BORROWED, EPOLLIN, handler);
+            poll.AddFd(socket_id, PollManager::FdType::SOCKET, PollManager::Ownership::BORROWED, EPOLLIN, handler);
+
+            // Closed behind the manager's back, epoll already forgot it
+            closesocket(closed_id);
+            const std::vector<SocketID> sockets{ closed_id, socket_id };
+            bool thrown = false;
+            try {
+                poll.RemoveBatch(sockets);
+            }
+            catch (const RuntimeError&) {
+                thrown = true;
+            }
+            VSOCK_CHECK(thrown);
+
+            SendAll(peer_id, "x");
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            VSOCK_CHECK(calls == 0);
+        }
+        closesocket(closed_peer);
+        closesocket(socket_id);
+        closesocket(peer_id);
+    }
+
+}
+
+int main() {
+    return Run({
+        { "batch_keeps_priority", BatchKeepsPriority },
+        { "batch_keeps_close_handler_and_ownership", BatchKeepsCloseHandlerAndOwnership },
+        { "batch_reports_failure_and_keeps_the_rest", BatchReportsFailureAndKeepsTheRest },
+        { "remove_batch_reports_failure", RemoveBatchReportsFailure }
+    });
+}
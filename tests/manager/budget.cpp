@@ -0,0 +1,84 @@
+#include <common/test.hpp>
+#include <pollmanager/manager/poll.hpp>
+
+#include <atomic>
+#include <thread>
+
+using namespace vsock;
+using namespace vsock::test;
+
+namespace {
+
+    // One handler worker: the bulk socket yields after its budget and the
+    // small socket is served before the bulk one is drained
+    void BudgetLetsOtherSocketsIn() {
+        ThreadPool threads(2);
+        auto [bulk_id, bulk_peer] = SocketPair();
+        auto [small_id, small_peer] = SocketPair();
+        std::atomic<bool> release{ false };
+        std::atomic<std::size_t> bulk_received{ 0 };
+        std::atomic<std::size_t> bulk_at_small{ 0 };
+        std::atomic<bool> small_done{ false };
+        const std::size_t bulk_size = 64 * 1024;
+        {
+            PollManager poll(&threads);
+            poll.SetReadBudget(4096, 0);
+            // Edge-triggered, the requeue is all that brings the bulk socket back
+            poll.AddReader(bulk_id, EPOLLIN | EPOLLET, [&](const SocketID, IOBuffer&& buffer) {
+                bulk_received += buffer.Size();
+            });
+            poll.AddReader(small_id, EPOLLIN | EPOLLET, [&](const SocketID, IOBuffer&& buffer) {
+                if (buffer && !small_done) {
+                    bulk_at_small = bulk_received.load();
+                    small_done = true;
+                }
+            });
+            threads.AddAsyncTask([&release]() {
+                while (!release) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            });
+
+            SendAll(bulk_peer, std::string(bulk_size, 'b'));
+            SendAll(small_peer, "s");
+            VSOCK_CHECK(Eventually([&]() { return poll.InFlight() == 2; }));
+            release = true;
+
+            VSOCK_CHECK(Eventually([&]() { return bulk_received == bulk_size && small_done; }));
+            VSOCK_CHECK(bulk_at_small < bulk_size);
+        }
+        closesocket(bulk_peer);
+        closesocket(small_peer);
+    }
+
+    void ReadCountBudget() {
+        ThreadPool threads(2);
+        auto [socket_id, peer_id] = SocketPair();
+        std::atomic<std::size_t> received{ 0 };
+        std::atomic<std::size_t> calls{ 0 };
+        const std::size_t size = 256 * 1024;
+        {
+            PollManager poll(&threads);
+            poll.SetReadBudget(0, 2);
+            poll.AddReader(socket_id, EPOLLIN | EPOLLET, [&](const SocketID, IOBuffer&& buffer) {
+                received += buffer.Size();
+                ++calls;
+            });
+            std::thread writer([&]() {
+                SendAll(peer_id, std::string(size, 'r'));
+            });
+            VSOCK_CHECK(Eventually([&]() { return received == size; }));
+            writer.join();
+            VSOCK_CHECK(calls >= 2);
+        }
+        closesocket(peer_id);
+    }
+
+}
+
+int main() {
+    return Run({
+        { "budget_lets_other_sockets_in", BudgetLetsOtherSocketsIn },
+        { "read_count_budget", ReadCountBudget }
+    });
+}
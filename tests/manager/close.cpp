@@ -0,0 +1,127 @@
+#include <common/test.hpp>
+#include <pollmanager/manager/poll.hpp>
+#include <core/error.hpp>
+
+#include <atomic>
+#include <fcntl.h>
+#include <thread>
+
+using namespace vsock;
+using namespace vsock::test;
+
+namespace {
+
+    // Bind() is refused for a socket the manager no longer knows
+    bool Registered(PollManager& poll, const SocketID socket_id) {
+        try {
+            poll.Bind(socket_id, 0);
+        }
+        catch (const RuntimeError&) {
+            return false;
+        }
+        return true;
+    }
+
+    // The handler runs once, the owned socket is forgotten and closed,
+    // the regular callback never runs after it
+    void PeerCloseRunsHandlerOnce() {
+        ThreadPool threads(2);
+        auto [socket_id, peer_id] = SocketPair();
+        std::atomic<std::size_t> calls{ 0 };
+        std::atomic<std::size_t> closes{ 0 };
+        std::atomic<std::size_t> late_calls{ 0 };
+        std::atomic<std::uint32_t> close_events{ 0 };
+        {
+            PollManager poll(&threads);
+            poll.Add(
+                socket_id, EPOLLIN,
+                [&](const SocketID id) {
+                    char data[8];
+                    while (::recv(id, data, sizeof(data), 0) > 0) {}
+                    if (closes > 0) {
+                        ++late_calls;
+                    }
+                    ++calls;
+                },
+                PollManager::Priority::NORMAL,
+                [&](const SocketID, const std::uint32_t events) {
+                    close_events = events;
+                    ++closes;
+                }
+            );
+            SendAll(peer_id, "x");
+            VSOCK_CHECK(Eventually([&]() { return calls > 0; }));
+
+            closesocket(peer_id);
+            VSOCK_CHECK(Eventually([&]() { return closes == 1; }));
+            VSOCK_CHECK((close_events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0);
+            VSOCK_CHECK(Eventually([&]() { return ::fcntl(socket_id, F_GETFD) == -1; }));
+            VSOCK_CHECK(!Registered(poll, socket_id));
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            VSOCK_CHECK(closes == 1);
+            VSOCK_CHECK(late_calls == 0);
+        }
+    }
+
+    // A borrowed fd stays open and leaves epoll, adding it again succeeds
+    void BorrowedFdLeavesEpoll() {
+        ThreadPool threads(2);
+        auto [socket_id, peer_id] = SocketPair();
+        std::atomic<std::size_t> closes{ 0 };
+        {
+            PollManager poll(&threads);
+            poll.AddFd(
+                socket_id, PollManager::FdType::SOCKET, PollManager::Ownership::BORROWED, EPOLLIN,
+                [](const SocketID id) {
+                    char data[8];
+                    while (::recv(id, data, sizeof(data), 0) > 0) {}
+                },
+                false, PollManager::Priority::NORMAL,
+                [&closes](const SocketID, const std::uint32_t) { ++closes; }
+            );
+            closesocket(peer_id);
+            VSOCK_CHECK(Eventually([&]() { return closes == 1; }));
+            VSOCK_CHECK(Eventually([&]() { return !Registered(poll, socket_id); }));
+            VSOCK_CHECK(::fcntl(socket_id, F_GETFD) != -1);
+
+            // EPOLL_CTL_ADD would fail with EEXIST and throw if it were still there
+            VSOCK_CHECK(poll.AddFd(
+                socket_id, PollManager::FdType::SOCKET, PollManager::Ownership::BORROWED, EPOLLIN | EPOLLONESHOT,
+                [](const SocketID) {}
+            ));
+            poll.Remove(socket_id);
+        }
+        closesocket(socket_id);
+    }
+
+    // A handler set on an existing registration picks up the hangup
+    void CloseHandlerSetLater() {
+        ThreadPool threads(2);
+        auto [socket_id, peer_id] = SocketPair();
+        std::atomic<std::size_t> closes{ 0 };
+        {
+            PollManager poll(&threads);
+            poll.Add(socket_id, EPOLLIN, [](const SocketID id) {
+                char data[8];
+                while (::recv(id, data, sizeof(data), 0) > 0) {}
+            });
+            poll.SetCloseHandler(socket_id, [&closes](const SocketID, const std::uint32_t) { ++closes; });
+
+            closesocket(peer_id);
+            VSOCK_CHECK(Eventually([&]() { return closes == 1; }));
+            VSOCK_CHECK(Eventually([&]() { return !Registered(poll, socket_id); }));
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            VSOCK_CHECK(closes == 1);
+        }
+    }
+
+}
+
+int main() {
+    return Run({
+        { "peer_close_runs_handler_once", PeerCloseRunsHandlerOnce },
+        { "borrowed_fd_leaves_epoll", BorrowedFdLeavesEpoll },
+        { "close_handler_set_later", CloseHandlerSetLater }
+    });
+}
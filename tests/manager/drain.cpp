@@ -0,0 +1,120 @@
+#include <common/test.hpp>
+#include <pollmanager/manager/poll.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace vsock;
+using namespace vsock::test;
+
+namespace {
+
+    // Handlers in flight finish first, then the sockets are handed back
+    void DrainWaitsForHandlers() {
+        ThreadPool threads(2);
+        auto [socket_id, peer_id] = SocketPair();
+        std::atomic<bool> entered{ false };
+        std::atomic<std::size_t> finished{ 0 };
+        {
+            PollManager poll(&threads);
+            poll.Add(socket_id, EPOLLIN | EPOLLONESHOT, [&](const SocketID id) {
+                entered = true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                char data[8];
+                while (::recv(id, data, sizeof(data), 0) > 0) {}
+                ++finished;
+                poll.ResetFlags(id);
+            });
+            SendAll(peer_id, "x");
+            VSOCK_CHECK(Eventually([&]() { return entered.load(); }));
+
+            std::vector<SocketID> released;
+            VSOCK_CHECK(poll.Drain(std::chrono::steady_clock::now() + std::chrono::seconds(5), &released));
+            VSOCK_CHECK(finished == 1);
+            VSOCK_CHECK(released == std::vector<SocketID>({ socket_id }));
+            VSOCK_CHECK(poll.InFlight() == 0);
+
+            // Detached, new data reaches nobody and the socket is still open
+            SendAll(peer_id, "y");
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            VSOCK_CHECK(finished == 1);
+            char data[8];
+            VSOCK_CHECK(::recv(socket_id, data, sizeof(data), 0) == 1);
+        }
+        closesocket(socket_id);
+        closesocket(peer_id);
+    }
+
+    void DrainGivesUpAtDeadline() {
+        ThreadPool threads(2);
+        auto [socket_id, peer_id] = SocketPair();
+        std::atomic<bool> entered{ false };
+        std::atomic<bool> release{ false };
+        {
+            PollManager poll(&threads);
+            poll.Add(socket_id, EPOLLIN | EPOLLONESHOT, [&](const SocketID) {
+                entered = true;
+                while (!release) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            });
+            SendAll(peer_id, "x");
+            VSOCK_CHECK(Eventually([&]() { return entered.load(); }));
+
+            std::vector<SocketID> released;
+            VSOCK_CHECK(!poll.Drain(std::chrono::steady_clock::now() + std::chrono::milliseconds(50), &released));
+            VSOCK_CHECK(released.size() == 1);
+            release = true;
+            VSOCK_CHECK(Eventually([&]() { return poll.InFlight() == 0; }));
+        }
+        closesocket(socket_id);
+        closesocket(peer_id);
+    }
+
+    // Without a list to hand them back to, owned sockets are closed
+    void DrainClosesOwnedSockets() {
+        ThreadPool threads(2);
+        auto [socket_id, peer_id] = SocketPair();
+        {
+            PollManager poll(&threads);
+            poll.Add(socket_id, EPOLLIN | EPOLLONESHOT, [](const SocketID) {});
+            VSOCK_CHECK(poll.Drain(std::chrono::steady_clock::now() + std::chrono::seconds(1)));
+            VSOCK_CHECK(RecvAll(peer_id, 1).empty());
+        }
+        closesocket(peer_id);
+    }
+
+    // A drain that gave up leaves the handler running, destruction waits for it
+    void DestructionWaitsForHandlers() {
+        ThreadPool threads(2);
+        auto [socket_id, peer_id] = SocketPair();
+        std::atomic<bool> entered{ false };
+        std::atomic<bool> finished{ false };
+        {
+            PollManager poll(&threads);
+            poll.Add(socket_id, EPOLLIN | EPOLLONESHOT, [&](const SocketID) {
+                entered = true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                finished = true;
+                // Still a live manager, the call only sees it stopping
+                poll.ResetFlags(socket_id);
+            });
+            SendAll(peer_id, "x");
+            VSOCK_CHECK(Eventually([&]() { return entered.load(); }));
+            VSOCK_CHECK(!poll.Drain(std::chrono::steady_clock::now() + std::chrono::milliseconds(10)));
+        }
+        VSOCK_CHECK(finished);
+        closesocket(peer_id);
+    }
+
+}
+
+int main() {
+    return Run({
+        { "drain_waits_for_handlers", DrainWaitsForHandlers },
+        { "drain_gives_up_at_deadline", DrainGivesUpAtDeadline },
+        { "drain_closes_owned_sockets", DrainClosesOwnedSockets },
+        { "destruction_waits_for_handlers", DestructionWaitsForHandlers }
+    });
+}
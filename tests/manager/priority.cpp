@@ -0,0 +1,88 @@
+#include <common/test.hpp>
+#include <pollmanager/manager/poll.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace vsock;
+using namespace vsock::test;
+
+namespace {
+
+    // One handler worker, held until both events are queued
+    void HighPriorityRunsFirst() {
+        ThreadPool threads(2);
+        auto [low_id, low_peer] = SocketPair();
+        auto [high_id, high_peer] = SocketPair();
+        std::atomic<bool> blocked{ false };
+        std::atomic<bool> release{ false };
+        std::mutex mtx;
+        std::vector<SocketID> order;
+        {
+            PollManager poll(&threads);
+            auto handler = [&](const SocketID id) {
+                char data[8];
+                while (::recv(id, data, sizeof(data), 0) > 0) {}
+                const std::scoped_lock lock(mtx);
+                order.push_back(id);
+            };
+            poll.Add(low_id, EPOLLIN | EPOLLONESHOT, handler, PollManager::Priority::LOW);
+            poll.Add(high_id, EPOLLIN | EPOLLONESHOT, handler, PollManager::Priority::HIGH);
+            // The reactor holds one worker, this blocks the other
+            threads.AddAsyncTask([&blocked, &release]() {
+                blocked = true;
+                while (!release) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            });
+            // Queued behind it, the handlers would overtake the blocker
+            VSOCK_CHECK(Eventually([&]() { return blocked.load(); }));
+
+            SendAll(low_peer, "low");
+            SendAll(high_peer, "high");
+            VSOCK_CHECK(Eventually([&]() { return poll.InFlight() == 2; }));
+            release = true;
+            VSOCK_CHECK(Eventually([&]() {
+                const std::scoped_lock lock(mtx);
+                return order.size() == 2;
+            }));
+            VSOCK_CHECK(order == std::vector<SocketID>({ high_id, low_id }));
+        }
+        closesocket(low_peer);
+        closesocket(high_peer);
+    }
+
+    // A steady stream of high priority work still lets low priority through
+    void LowPriorityIsNotStarved() {
+        ThreadPool threads(1);
+        std::atomic<bool> release{ false };
+        std::atomic<std::size_t> high_ran{ 0 };
+        std::atomic<std::size_t> high_before_low{ 0 };
+        std::atomic<bool> low_ran{ false };
+        threads.AddAsyncTask([&release]() {
+            while (!release) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+        threads.AddPriorityTask(ThreadPool::Priority::LOW, [&]() {
+            high_before_low = high_ran.load();
+            low_ran = true;
+        });
+        for (std::size_t i = 0; i < 100; ++i) {
+            threads.AddPriorityTask(ThreadPool::Priority::HIGH, [&high_ran]() { ++high_ran; });
+        }
+        release = true;
+        VSOCK_CHECK(Eventually([&]() { return low_ran && high_ran == 100; }));
+        VSOCK_CHECK(high_before_low < 100);
+    }
+
+}
+
+int main() {
+    return Run({
+        { "high_priority_runs_first", HighPriorityRunsFirst },
+        { "low_priority_is_not_starved", LowPriorityIsNotStarved }
+    });
+}
@@ -0,0 +1,108 @@
+#include <common/test.hpp>
+#include <pollmanager/manager/poll.hpp>
+
+#include <atomic>
+#include <string>
+
+#include <time.h>
+
+using namespace vsock;
+using namespace vsock::test;
+
+namespace {
+
+    // Burns thread CPU time, sleeping would not show up in the profile
+    void Spin(const std::chrono::milliseconds duration) {
+        struct timespec started;
+        struct timespec now;
+        ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &started);
+        do {
+            ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+        } while ((now.tv_sec - started.tv_sec) * 1000000000LL + (now.tv_nsec - started.tv_nsec) <
+            std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+    }
+
+    // The busy socket leads every key, the quiet one follows
+    void HotSocketLeadsEveryKey() {
+        ThreadPool threads(2);
+        auto [hot_id, hot_peer] = SocketPair();
+        auto [cold_id, cold_peer] = SocketPair();
+        std::atomic<std::size_t> hot_bytes{ 0 };
+        std::atomic<std::size_t> cold_bytes{ 0 };
+        {
+            PollManager poll(&threads);
+            poll.SetProfiling(true);
+            poll.AddReader(hot_id, EPOLLIN | EPOLLONESHOT, [&](const SocketID id, IOBuffer&& buffer) {
+                Spin(std::chrono::milliseconds(5));
+                hot_bytes += buffer.Size();
+                poll.ResetFlags(id);
+            });
+            poll.AddReader(cold_id, EPOLLIN | EPOLLONESHOT, [&](const SocketID id, IOBuffer&& buffer) {
+                cold_bytes += buffer.Size();
+                poll.ResetFlags(id);
+            });
+
+            // One event per send, each is consumed before the next one
+            for (std::size_t i = 0; i < 4; ++i) {
+                SendAll(hot_peer, std::string(100, 'h'));
+                VSOCK_CHECK(Eventually([&]() { return hot_bytes == (i + 1) * 100; }));
+            }
+            SendAll(cold_peer, "c");
+            VSOCK_CHECK(Eventually([&]() { return cold_bytes == 1; }));
+            // Counters are added after the handler returns
+            VSOCK_CHECK(Eventually([&]() { return poll.InFlight() == 0; }));
+
+            const auto by_events = poll.TopSockets(2, PollManager::ProfileKey::EVENTS);
+            VSOCK_CHECK(by_events.size() == 2);
+            VSOCK_CHECK(by_events[0].fd == hot_id);
+            VSOCK_CHECK(by_events[0].events == 4);
+            VSOCK_CHECK(by_events[1].fd == cold_id);
+            VSOCK_CHECK(by_events[1].events == 1);
+
+            const auto by_bytes = poll.TopSockets(1, PollManager::ProfileKey::BYTES);
+            VSOCK_CHECK(by_bytes.size() == 1);
+            VSOCK_CHECK(by_bytes[0].fd == hot_id);
+            VSOCK_CHECK(by_bytes[0].bytes == 400);
+
+            const auto by_cpu = poll.TopSockets(2, PollManager::ProfileKey::CPU);
+            VSOCK_CHECK(by_cpu.size() == 2);
+            VSOCK_CHECK(by_cpu[0].fd == hot_id);
+            VSOCK_CHECK(by_cpu[0].cpu >= std::chrono::milliseconds(20));
+            VSOCK_CHECK(by_cpu[1].cpu < by_cpu[0].cpu);
+        }
+        closesocket(hot_peer);
+        closesocket(cold_peer);
+    }
+
+    // Nothing is counted while profiling is off
+    void DisabledProfilingCountsNothing() {
+        ThreadPool threads(2);
+        auto [socket_id, peer_id] = SocketPair();
+        std::atomic<std::size_t> bytes{ 0 };
+        {
+            PollManager poll(&threads);
+            poll.AddReader(socket_id, EPOLLIN | EPOLLONESHOT, [&](const SocketID id, IOBuffer&& buffer) {
+                bytes += buffer.Size();
+                poll.ResetFlags(id);
+            });
+            SendAll(peer_id, "data");
+            VSOCK_CHECK(Eventually([&]() { return bytes == 4; }));
+            VSOCK_CHECK(Eventually([&]() { return poll.InFlight() == 0; }));
+
+            const auto top = poll.TopSockets(5, PollManager::ProfileKey::EVENTS);
+            VSOCK_CHECK(top.size() == 1);
+            VSOCK_CHECK(top[0].events == 0);
+            VSOCK_CHECK(top[0].bytes == 0);
+            VSOCK_CHECK(top[0].cpu == std::chrono::nanoseconds(0));
+        }
+        closesocket(peer_id);
+    }
+
+}
+
+int main() {
+    return Run({
+        { "hot_socket_leads_every_key", HotSocketLeadsEveryKey },
+        { "disabled_profiling_counts_nothing", DisabledProfilingCountsNothing }
+    });
+}
@@ -0,0 +1,126 @@
+#include <common/test.hpp>
+#include <pollmanager/manager/poll.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace vsock;
+using namespace vsock::test;
+
+namespace {
+
+    // Racing first posts start a single reactor, every job runs on its thread
+    void ConcurrentPostsStartOneReactor() {
+        ThreadPool threads(4);
+        for (std::size_t round = 0; round < 20; ++round) {
+            std::mutex mtx;
+            std::set<std::thread::id> runners;
+            std::atomic<std::size_t> ran{ 0 };
+            std::atomic<std::size_t> ready{ 0 };
+            {
+                PollManager poll(&threads);
+                std::vector<std::thread> posters;
+                for (std::size_t i = 0; i < 4; ++i) {
+                    posters.emplace_back([&]() {
+                        ++ready;
+                        while (ready < 4) {
+                            std::this_thread::yield();
+                        }
+                        for (std::size_t job = 0; job < 100; ++job) {
+                            poll.Post([&]() {
+                                {
+                                    const std::scoped_lock lock(mtx);
+                                    runners.insert(std::this_thread::get_id());
+                                }
+                                ++ran;
+                            });
+                        }
+                    });
+                }
+                for (std::thread& poster : posters) {
+                    poster.join();
+                }
+                VSOCK_CHECK(Eventually([&]() { return ran == 400; }));
+            }
+            VSOCK_CHECK(runners.size() == 1);
+        }
+    }
+
+    // A second reactor would hold the other worker and no handler would ever run
+    void ConcurrentAddsStartOneReactor() {
+        ThreadPool threads(2);
+        for (std::size_t round = 0; round < 20; ++round) {
+            std::vector<std::pair<SocketID, SocketID>> pairs;
+            for (std::size_t i = 0; i < 4; ++i) {
+                pairs.push_back(SocketPair());
+            }
+            std::atomic<std::size_t> ready{ 0 };
+            std::atomic<std::size_t> handled{ 0 };
+            {
+                PollManager poll(&threads);
+                std::vector<std::thread> adders;
+                for (std::size_t i = 0; i < 4; ++i) {
+                    adders.emplace_back([&, i]() {
+                        ++ready;
+                        while (ready < 4) {
+                            std::this_thread::yield();
+                        }
+                        poll.AddFd(
+                            pairs[i].first, PollManager::FdType::SOCKET, PollManager::Ownership::BORROWED, EPOLLIN | EPOLLONESHOT,
+                            [&handled](const SocketID) { ++handled; }
+                        );
+                    });
+                }
+                for (std::thread& adder : adders) {
+                    adder.join();
+                }
+                for (const auto& pair : pairs) {
+                    SendAll(pair.second, "x");
+                }
+                VSOCK_CHECK(Eventually([&]() { return handled == 4; }));
+            }
+            for (const auto& pair : pairs) {
+                closesocket(pair.first);
+                closesocket(pair.second);
+            }
+        }
+    }
+
+    // The reactor task still queued behind a busy worker refers to the manager
+    void DestructionWaitsForQueuedReactor() {
+        ThreadPool threads(1);
+        std::atomic<bool> blocked{ false };
+        std::atomic<bool> release{ false };
+        threads.AddAsyncTask([&blocked, &release]() {
+            blocked = true;
+            while (!release) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+        VSOCK_CHECK(Eventually([&]() { return blocked.load(); }));
+
+        std::thread releaser([&release]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            release = true;
+        });
+        {
+            PollManager poll(&threads);
+            poll.Post([]() {});
+        }
+        const bool waited = release;
+        releaser.join();
+        VSOCK_CHECK(waited);
+    }
+
+}
+
+int main() {
+    return Run({
+        { "concurrent_posts_start_one_reactor", ConcurrentPostsStartOneReactor },
+        { "concurrent_adds_start_one_reactor", ConcurrentAddsStartOneReactor },
+        { "destruction_waits_for_queued_reactor", DestructionWaitsForQueuedReactor }
+    });
+}
@@ -0,0 +1,141 @@
+#include <common/test.hpp>
+#include <pollmanager/manager/poll.hpp>
+
+#include <atomic>
+#include <cerrno>
+#include <thread>
+
+using namespace vsock;
+using namespace vsock::test;
+
+namespace {
+
+    // Level-triggered events keep coming while the handler runs, they are
+    // coalesced into replays instead of running the handler concurrently
+    void HandlersNeverOverlap() {
+        ThreadPool threads(4);
+        auto [socket_id, peer_id] = SocketPair();
+        std::atomic<std::size_t> active{ 0 };
+        std::atomic<std::size_t> overlaps{ 0 };
+        std::atomic<std::size_t> runs{ 0 };
+        std::atomic<std::size_t> received{ 0 };
+        {
+            PollManager poll(&threads);
+            poll.AddSerial(socket_id, EPOLLIN, [&](const SocketID id) {
+                if (active.fetch_add(1) != 0) {
+                    ++overlaps;
+                }
+                char data[64];
+                const ssize_t result = ::recv(id, data, sizeof(data), 0);
+                if (result > 0) {
+                    received += static_cast<std::size_t>(result);
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                ++runs;
+                --active;
+            });
+
+            for (std::size_t i = 0; i < 64; ++i) {
+                SendAll(peer_id, std::string(64, 's'));
+            }
+            VSOCK_CHECK(Eventually([&]() { return received == 64 * 64; }));
+            VSOCK_CHECK(overlaps == 0);
+            VSOCK_CHECK(Eventually([&]() { return runs >= 64; }));
+        }
+        closesocket(peer_id);
+    }
+
+    // Events that arrive while the handler runs are not lost
+    void EventsDuringRunAreReplayed() {
+        ThreadPool threads(2);
+        auto [socket_id, peer_id] = SocketPair();
+        std::atomic<bool> entered{ false };
+        std::atomic<bool> release{ false };
+        std::atomic<std::size_t> received{ 0 };
+        {
+            PollManager poll(&threads);
+            poll.AddSerial(socket_id, EPOLLIN | EPOLLET, [&](const SocketID id) {
+                entered = true;
+                while (!release) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                char data[64];
+                ssize_t result;
+                while ((result = ::recv(id, data, sizeof(data), 0)) > 0) {
+                    received += static_cast<std::size_t>(result);
+                }
+            });
+
+            SendAll(peer_id, "first");
+            VSOCK_CHECK(Eventually([&]() { return entered.load(); }));
+            // Edge-triggered, this is reported once while the handler is blocked
+            SendAll(peer_id, "second");
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            release = true;
+            VSOCK_CHECK(Eventually([&]() { return received == 11; }));
+
+            SendAll(peer_id, "third");
+            VSOCK_CHECK(Eventually([&]() { return received == 16; }));
+        }
+        closesocket(peer_id);
+    }
+
+    // The hangup waits for the running handler, then the close runs on the strand
+    void CloseWaitsForRunningHandler() {
+        ThreadPool threads(4);
+        auto [socket_id, peer_id] = SocketPair();
+        std::atomic<bool> entered{ false };
+        std::atomic<bool> release{ false };
+        std::atomic<std::size_t> active{ 0 };
+        std::atomic<std::size_t> overlaps{ 0 };
+        std::atomic<std::size_t> bad_fds{ 0 };
+        std::atomic<std::size_t> closes{ 0 };
+        {
+            PollManager poll(&threads);
+            poll.AddFd(
+                socket_id, PollManager::FdType::SOCKET, PollManager::Ownership::OWNED, EPOLLIN,
+                [&](const SocketID id) {
+                    if (active.fetch_add(1) != 0) {
+                        ++overlaps;
+                    }
+                    entered = true;
+                    while (!release) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    }
+                    char data[64];
+                    if (::recv(id, data, sizeof(data), 0) == -1 && errno == EBADF) {
+                        ++bad_fds;
+                    }
+                    --active;
+                },
+                true, PollManager::Priority::NORMAL,
+                [&](const SocketID, const std::uint32_t) {
+                    if (active != 0) {
+                        ++overlaps;
+                    }
+                    ++closes;
+                }
+            );
+
+            SendAll(peer_id, "x");
+            VSOCK_CHECK(Eventually([&]() { return entered.load(); }));
+            closesocket(peer_id);
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            VSOCK_CHECK(closes == 0);
+
+            release = true;
+            VSOCK_CHECK(Eventually([&]() { return closes == 1; }));
+            VSOCK_CHECK(overlaps == 0);
+            VSOCK_CHECK(bad_fds == 0);
+        }
+    }
+
+}
+
+int main() {
+    return Run({
+        { "handlers_never_overlap", HandlersNeverOverlap },
+        { "events_during_run_are_replayed", EventsDuringRunAreReplayed },
+        { "close_waits_for_running_handler", CloseWaitsForRunningHandler }
+    });
+}
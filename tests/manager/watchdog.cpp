@@ -0,0 +1,141 @@
+#include <common/test.hpp>
+#include <pollmanager/manager/poll.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace vsock;
+using namespace vsock::test;
+
+namespace {
+
+    // A long handler is reported once, with its fd and how long it ran
+    void StalledHandlerIsReportedOnce() {
+        ThreadPool threads(2);
+        auto [socket_id, peer_id] = SocketPair();
+        std::atomic<bool> finished{ false };
+        std::mutex mtx;
+        std::vector<Watchdog::stall_t> stalls;
+        {
+            PollManager poll(&threads);
+            poll.EnableWatchdog(std::chrono::milliseconds(40), [&](const Watchdog::stall_t& stall) {
+                const std::scoped_lock lock(mtx);
+                stalls.push_back(stall);
+            });
+            poll.Add(socket_id, EPOLLIN | EPOLLONESHOT, [&](const SocketID id) {
+                char data[8];
+                while (::recv(id, data, sizeof(data), 0) > 0) {}
+                std::this_thread::sleep_for(std::chrono::milliseconds(300));
+                finished = true;
+            });
+
+            SendAll(peer_id, "x");
+            VSOCK_CHECK(Eventually([&]() { return finished.load(); }));
+            // A few more periods, the same handler must not be reported again
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            poll.DisableWatchdog();
+
+            const std::scoped_lock lock(mtx);
+            std::size_t handler_stalls = 0;
+            for (const Watchdog::stall_t& stall : stalls) {
+                if (stall.fd == socket_id) {
+                    ++handler_stalls;
+                    VSOCK_CHECK(stall.elapsed >= std::chrono::milliseconds(40));
+                    VSOCK_CHECK(stall.label == std::string("handler"));
+                }
+            }
+            VSOCK_CHECK(handler_stalls == 1);
+        }
+        closesocket(peer_id);
+    }
+
+    // A posted job that holds the reactor delays the probe past the threshold
+    void StalledReactorIsReported() {
+        ThreadPool threads(2);
+        std::atomic<bool> reactor_stalled{ false };
+        {
+            PollManager poll(&threads);
+            poll.EnableWatchdog(std::chrono::milliseconds(40), [&](const Watchdog::stall_t& stall) {
+                if (stall.fd == VSOCK_INVALID_SOCKET) {
+                    reactor_stalled = true;
+                }
+            });
+            poll.Post([]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(300));
+            });
+            VSOCK_CHECK(Eventually([&]() { return reactor_stalled.load(); }));
+            // No newer probe overwrites the lag of the stalled one once it is served
+            poll.DisableWatchdog();
+            VSOCK_CHECK(Eventually([&]() { return poll.LoopLag() >= std::chrono::milliseconds(40); }));
+        }
+    }
+
+    // Quick handlers and an idle loop report nothing
+    void HealthyLoopIsQuiet() {
+        ThreadPool threads(2);
+        auto [socket_id, peer_id] = SocketPair();
+        std::atomic<std::size_t> reports{ 0 };
+        std::atomic<std::size_t> calls{ 0 };
+        {
+            PollManager poll(&threads);
+            poll.EnableWatchdog(std::chrono::milliseconds(200), [&](const Watchdog::stall_t&) {
+                ++reports;
+            });
+            poll.Add(socket_id, EPOLLIN, [&](const SocketID id) {
+                char data[8];
+                while (::recv(id, data, sizeof(data), 0) > 0) {}
+                ++calls;
+            });
+            for (std::size_t i = 0; i < 5; ++i) {
+                SendAll(peer_id, "x");
+                VSOCK_CHECK(Eventually([&]() { return calls > i; }));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(300));
+            poll.DisableWatchdog();
+            VSOCK_CHECK(reports == 0);
+        }
+        closesocket(peer_id);
+    }
+
+    // A worker past the slots known at construction, as added by a pool reset, is watched too
+    void WorkerAddedLaterIsWatched() {
+        Watchdog watchdog(2);
+        const std::size_t worker = VSOCK_WATCHDOG_CHUNK + 5;
+        std::mutex mtx;
+        std::vector<Watchdog::stall_t> stalls;
+        watchdog.Start(
+            std::chrono::milliseconds(20), std::chrono::milliseconds(5),
+            [&](const Watchdog::stall_t& stall) {
+                const std::scoped_lock lock(mtx);
+                stalls.push_back(stall);
+            },
+            [](std::function<void(void)>&& job) { job(); }
+        );
+        watchdog.Begin(worker, 42, "late worker");
+        VSOCK_CHECK(Eventually([&]() {
+            const std::scoped_lock lock(mtx);
+            return !stalls.empty();
+        }));
+        watchdog.End(worker);
+        watchdog.Stop();
+
+        const std::scoped_lock lock(mtx);
+        VSOCK_CHECK(stalls.size() == 1);
+        VSOCK_CHECK(stalls[0].worker == worker);
+        VSOCK_CHECK(stalls[0].fd == 42);
+        VSOCK_CHECK(stalls[0].label == std::string("late worker"));
+    }
+
+}
+
+int main() {
+    return Run({
+        { "stalled_handler_is_reported_once", StalledHandlerIsReportedOnce },
+        { "stalled_reactor_is_reported", StalledReactorIsReported },
+        { "healthy_loop_is_quiet", HealthyLoopIsQuiet },
+        { "worker_added_later_is_watched", WorkerAddedLaterIsWatched }
+    });
+}
@@ -0,0 +1,71 @@
+#include <common/test.hpp>
+#include <pollmanager/metrics/metrics.hpp>
+
+#include <thread>
+#include <vector>
+
+using namespace vsock;
+using namespace vsock::test;
+
+namespace {
+
+    std::uint64_t Counter(const Metrics::snapshot_t& snapshot, const Metrics::Counter counter) {
+        return snapshot.counters[static_cast<std::size_t>(counter)];
+    }
+
+    void DisabledRecordsNothing() {
+        Metrics metrics;
+        metrics.Add(Metrics::Counter::EVENTS);
+        metrics.Record(Metrics::Histogram::NFDS, 4);
+        const Metrics::snapshot_t snapshot = metrics.Snapshot();
+        VSOCK_CHECK(Counter(snapshot, Metrics::Counter::EVENTS) == 0);
+        VSOCK_CHECK(Metrics::Count(snapshot, Metrics::Histogram::NFDS) == 0);
+    }
+
+    // Samples of threads that exited stay in the totals
+    void ExitedThreadsAreCounted() {
+        Metrics metrics;
+        metrics.SetEnabled(true);
+        for (std::size_t round = 0; round < 4; ++round) {
+            std::vector<std::thread> workers;
+            for (std::size_t i = 0; i < 4; ++i) {
+                workers.emplace_back([&metrics]() {
+                    for (std::size_t n = 0; n < 100; ++n) {
+                        metrics.Add(Metrics::Counter::EVENTS);
+                        metrics.Record(Metrics::Histogram::NFDS, 3);
+                    }
+                });
+            }
+            for (std::thread& worker : workers) {
+                worker.join();
+            }
+        }
+        metrics.Add(Metrics::Counter::TASKS, 5);
+
+        const Metrics::snapshot_t snapshot = metrics.Snapshot();
+        VSOCK_CHECK(Counter(snapshot, Metrics::Counter::EVENTS) == 1600);
+        VSOCK_CHECK(Counter(snapshot, Metrics::Counter::TASKS) == 5);
+        VSOCK_CHECK(Metrics::Count(snapshot, Metrics::Histogram::NFDS) == 1600);
+        VSOCK_CHECK(snapshot.sums[static_cast<std::size_t>(Metrics::Histogram::NFDS)] == 4800);
+        VSOCK_CHECK(Metrics::Percentile(snapshot, Metrics::Histogram::NFDS, 50.0) == 3);
+    }
+
+    // A thread outliving one Metrics never reaches into the next one
+    void InstancesAreSeparate() {
+        for (std::size_t i = 0; i < 3; ++i) {
+            Metrics metrics;
+            metrics.SetEnabled(true);
+            metrics.Add(Metrics::Counter::EVENTS, i + 1);
+            VSOCK_CHECK(Counter(metrics.Snapshot(), Metrics::Counter::EVENTS) == i + 1);
+        }
+    }
+
+}
+
+int main() {
+    return Run({
+        { "disabled_records_nothing", DisabledRecordsNothing },
+        { "exited_threads_are_counted", ExitedThreadsAreCounted },
+        { "instances_are_separate", InstancesAreSeparate }
+    });
+}
@@ -0,0 +1,141 @@
+#include <common/test.hpp>
+#include <pollmanager/relay/relay.hpp>
+
+#include <atomic>
+#include <thread>
+
+#include <sys/resource.h>
+
+using namespace vsock;
+using namespace vsock::test;
+
+namespace {
+
+    // Both directions move at once and more than a pipe holds
+    void RelaysBothDirections() {
+        ThreadPool threads(3);
+        auto [first_id, first_peer] = SocketPair();
+        auto [second_id, second_peer] = SocketPair();
+        std::atomic<bool> closed{ false };
+
+        std::string forward(1024 * 1024, '\0');
+        std::string backward(512 * 1024, '\0');
+        for (std::size_t i = 0; i < forward.size(); ++i) {
+            forward[i] = static_cast<char>(i * 7);
+        }
+        for (std::size_t i = 0; i < backward.size(); ++i) {
+            backward[i] = static_cast<char>(i * 13);
+        }
+        {
+            PollManager poll(&threads);
+            auto relay = std::make_shared<Relay>(&poll, first_id, second_id);
+            relay->Start([&closed](const SocketID, const SocketID) {
+                closed = true;
+            });
+
+            std::thread forward_writer([&]() {
+                SendAll(first_peer, forward);
+                ::shutdown(first_peer, SHUT_WR);
+            });
+            std::thread backward_writer([&]() {
+                SendAll(second_peer, backward);
+                ::shutdown(second_peer, SHUT_WR);
+            });
+            const std::string forwarded = RecvAll(second_peer, forward.size());
+            const std::string backwarded = RecvAll(first_peer, backward.size());
+            forward_writer.join();
+            backward_writer.join();
+
+            VSOCK_CHECK(forwarded == forward);
+            VSOCK_CHECK(backwarded == backward);
+            // Each half-close is passed on, then the relay closes itself
+            VSOCK_CHECK(RecvAll(second_peer, 1).empty());
+            VSOCK_CHECK(RecvAll(first_peer, 1).empty());
+            VSOCK_CHECK(Eventually([&]() { return closed.load(); }));
+            VSOCK_CHECK(relay->Closed());
+            VSOCK_CHECK(relay->Relayed() == forward.size() + backward.size());
+        }
+        for (const SocketID socket_id : { first_id, first_peer, second_id, second_peer }) {
+            closesocket(socket_id);
+        }
+    }
+
+    std::chrono::microseconds ProcessCpu() {
+        struct rusage usage;
+        ::getrusage(RUSAGE_SELF, &usage);
+        return std::chrono::seconds(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+            std::chrono::microseconds(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+    }
+
+    // One side half-closes, the relay idles and the other direction still moves
+    void HalfCloseKeepsReverseDirection() {
+        ThreadPool threads(2);
+        auto [first_id, first_peer] = TcpPair();
+        auto [second_id, second_peer] = TcpPair();
+        std::atomic<bool> closed{ false };
+        {
+            PollManager poll(&threads);
+            auto relay = std::make_shared<Relay>(&poll, first_id, second_id);
+            relay->Start([&closed](const SocketID, const SocketID) {
+                closed = true;
+            });
+
+            SendAll(first_peer, "last");
+            ::shutdown(first_peer, SHUT_WR);
+            VSOCK_CHECK(RecvAll(second_peer, 4) == "last");
+            VSOCK_CHECK(RecvAll(second_peer, 1).empty());
+
+            // A source rearmed after its eof reports RDHUP on every wait
+            const std::chrono::microseconds before = ProcessCpu();
+            std::this_thread::sleep_for(std::chrono::milliseconds(300));
+            VSOCK_CHECK(ProcessCpu() - before < std::chrono::milliseconds(60));
+            VSOCK_CHECK(!closed);
+
+            SendAll(second_peer, "reply");
+            VSOCK_CHECK(RecvAll(first_peer, 5) == "reply");
+            ::shutdown(second_peer, SHUT_WR);
+            VSOCK_CHECK(RecvAll(first_peer, 1).empty());
+            VSOCK_CHECK(Eventually([&]() { return closed.load(); }));
+        }
+        for (const SocketID socket_id : { first_id, first_peer, second_id, second_peer }) {
+            closesocket(socket_id);
+        }
+    }
+
+    void StopDetachesSockets() {
+        ThreadPool threads(2);
+        auto [first_id, first_peer] = SocketPair();
+        auto [second_id, second_peer] = SocketPair();
+        std::atomic<bool> closed{ false };
+        {
+            PollManager poll(&threads);
+            auto relay = std::make_shared<Relay>(&poll, first_id, second_id);
+            relay->Start([&closed](const SocketID, const SocketID) {
+                closed = true;
+            });
+            SendAll(first_peer, "before");
+            VSOCK_CHECK(RecvAll(second_peer, 6) == "before");
+
+            relay->Stop();
+            VSOCK_CHECK(relay->Closed());
+            SendAll(first_peer, "after");
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            // Nothing is moved and the close handler is not run for a stop
+            char data[8];
+            VSOCK_CHECK(::recv(second_peer, data, sizeof(data), MSG_DONTWAIT) == -1);
+            VSOCK_CHECK(!closed);
+        }
+        for (const SocketID socket_id : { first_id, first_peer, second_id, second_peer }) {
+            closesocket(socket_id);
+        }
+    }
+
+}
+
+int main() {
+    return Run({
+        { "relays_both_directions", RelaysBothDirections },
+        { "half_close_keeps_reverse_direction", HalfCloseKeepsReverseDirection },
+        { "stop_detaches_sockets", StopDetachesSockets }
+    });
+}
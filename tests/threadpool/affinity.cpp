@@ -0,0 +1,144 @@
+#include <common/test.hpp>
+#include <threadpool/threadpool.hpp>
+
+#include <atomic>
+#include <thread>
+
+using namespace vsock;
+using namespace vsock::test;
+
+namespace {
+
+    // Every push races a worker that is about to sleep, none may be missed
+    void AffineTasksAreNotLost() {
+        ThreadPool threads(4);
+        std::atomic<std::size_t> ran{ 0 };
+        for (std::size_t round = 0; round < 2000; ++round) {
+            threads.AddAffineTask(round % 4, [&ran]() { ++ran; });
+            VSOCK_CHECK(Eventually([&]() { return ran == round + 1; }));
+        }
+    }
+
+    void AffineTasksRunOnTheirWorker() {
+        ThreadPool threads(3);
+        std::atomic<std::size_t> misplaced{ 0 };
+        std::atomic<std::size_t> ran{ 0 };
+        for (std::size_t i = 0; i < 300; ++i) {
+            const std::size_t worker = i % 3;
+            threads.AddAffineTask(worker, [&, worker]() {
+                if (threads.CurrentWorker() != worker) {
+                    ++misplaced;
+                }
+                ++ran;
+            });
+        }
+        VSOCK_CHECK(Eventually([&]() { return ran == 300; }));
+        VSOCK_CHECK(misplaced == 0);
+    }
+
+    // Each push wakes a different sleeper, all tasks have to run at once
+    void SharedTasksWakeDistinctWorkers() {
+        ThreadPool threads(4);
+        std::atomic<std::size_t> running{ 0 };
+        std::atomic<std::size_t> met{ 0 };
+        for (std::size_t i = 0; i < 4; ++i) {
+            threads.AddAsyncTask([&]() {
+                ++running;
+                const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+                while (running < 4 && std::chrono::steady_clock::now() < deadline) {
+                    std::this_thread::yield();
+                }
+                if (running == 4) {
+                    ++met;
+                }
+            });
+        }
+        VSOCK_CHECK(Eventually([&]() { return met == 4; }, std::chrono::seconds(10)));
+    }
+
+    void ContinueWakesEveryWorker() {
+        ThreadPool threads(3);
+        std::atomic<std::size_t> ran{ 0 };
+        threads.Pause();
+        for (std::size_t i = 0; i < 30; ++i) {
+            threads.AddAffineTask(i % 3, [&ran]() { ++ran; });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        VSOCK_CHECK(ran == 0);
+        threads.Continue();
+        VSOCK_CHECK(Eventually([&]() { return ran == 30; }));
+    }
+
+    // The owner is stuck in a long task, an idle worker takes what it holds
+    void BlockedOwnerTasksAreTaken() {
+        ThreadPool threads(2);
+        std::atomic<bool> blocked{ false };
+        std::atomic<bool> release{ false };
+        std::atomic<std::size_t> ran{ 0 };
+        threads.AddAffineTask(0, [&]() {
+            blocked = true;
+            while (!release) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+        VSOCK_CHECK(Eventually([&]() { return blocked.load(); }));
+        for (std::size_t i = 0; i < 10; ++i) {
+            threads.AddAffineTask(0, [&]() {
+                if (threads.CurrentWorker() == 1) {
+                    ++ran;
+                }
+            });
+        }
+        VSOCK_CHECK(Eventually([&]() { return ran == 10; }));
+        release = true;
+        threads.Wait();
+    }
+
+    // With stealing off the tasks wait for their owner
+    void StealingCanBeDisabled() {
+        ThreadPool threads(2);
+        threads.SetStealAfter(std::chrono::microseconds(0));
+        std::atomic<bool> blocked{ false };
+        std::atomic<bool> release{ false };
+        std::atomic<std::size_t> ran{ 0 };
+        threads.AddAffineTask(0, [&]() {
+            blocked = true;
+            while (!release) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+        VSOCK_CHECK(Eventually([&]() { return blocked.load(); }));
+        threads.AddAffineTask(0, [&ran]() { ++ran; });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        VSOCK_CHECK(ran == 0);
+        release = true;
+        VSOCK_CHECK(Eventually([&]() { return ran == 1; }));
+    }
+
+    // Paused, so the queued tasks outlive the workers they were meant for
+    void AffineTasksSurviveReset() {
+        ThreadPool threads(3);
+        std::atomic<std::size_t> ran{ 0 };
+        threads.Pause();
+        for (std::size_t i = 0; i < 30; ++i) {
+            threads.AddAffineTask(i % 3, [&ran]() { ++ran; });
+        }
+        threads.Reset(2);
+        VSOCK_CHECK(ran == 0);
+        threads.Continue();
+        VSOCK_CHECK(Eventually([&]() { return ran == 30; }));
+    }
+
+}
+
+int main() {
+    return Run({
+        { "affine_tasks_are_not_lost", AffineTasksAreNotLost },
+        { "affine_tasks_run_on_their_worker", AffineTasksRunOnTheirWorker },
+        { "shared_tasks_wake_distinct_workers", SharedTasksWakeDistinctWorkers },
+        { "continue_wakes_every_worker", ContinueWakesEveryWorker },
+        { "blocked_owner_tasks_are_taken", BlockedOwnerTasksAreTaken },
+        { "stealing_can_be_disabled", StealingCanBeDisabled },
+        { "affine_tasks_survive_reset", AffineTasksSurviveReset }
+    });
+}
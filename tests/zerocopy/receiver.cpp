@@ -0,0 +1,77 @@
+#include <common/test.hpp>
+#include <pollmanager/manager/poll.hpp>
+
+#include <atomic>
+#include <mutex>
+
+using namespace vsock;
+using namespace vsock::test;
+
+namespace {
+
+    // Mapped pages and the copied tail reach the handler in stream order
+    void ReaderSeesWholeStream() {
+        ThreadPool threads(2);
+        BufferPool pool;
+        std::mutex mtx;
+        std::string received;
+        std::atomic<bool> closed{ false };
+        auto [socket_id, peer_id] = TcpPair();
+
+        std::string payload(256 * 1024 + 123, '\0');
+        for (std::size_t i = 0; i < payload.size(); ++i) {
+            payload[i] = static_cast<char>('a' + i % 26);
+        }
+        {
+            PollManager poll(&threads, &pool);
+            poll.AddZeroCopyReader(socket_id, EPOLLIN | EPOLLONESHOT, [&](const SocketID id, std::string_view view) {
+                if (view.empty()) {
+                    closed = true;
+                    return;
+                }
+                {
+                    const std::scoped_lock lock(mtx);
+                    received.append(view);
+                }
+                poll.ResetFlags(id);
+            });
+
+            SendAll(peer_id, payload);
+            VSOCK_CHECK(Eventually([&]() {
+                const std::scoped_lock lock(mtx);
+                return received.size() == payload.size();
+            }));
+            VSOCK_CHECK(received == payload);
+
+            closesocket(peer_id);
+            VSOCK_CHECK(Eventually([&]() { return closed.load(); }));
+        }
+    }
+
+    // Socket types without TCP_ZEROCOPY_RECEIVE fall back to plain copies
+    void UnixSocketFallsBackToCopy() {
+        BufferPool pool;
+        auto [socket_id, peer_id] = SocketPair();
+        ZeroCopyReceiver receiver(socket_id, &pool);
+        SendAll(peer_id, "unmapped");
+
+        std::string received;
+        const std::ptrdiff_t result = receiver.Receive([&received](std::string_view view) {
+            received.append(view);
+        });
+        VSOCK_CHECK(result == 8);
+        VSOCK_CHECK(received == "unmapped");
+        VSOCK_CHECK(!receiver.Mapped());
+
+        closesocket(socket_id);
+        closesocket(peer_id);
+    }
+
+}
+
+int main() {
+    return Run({
+        { "reader_sees_whole_stream", ReaderSeesWholeStream },
+        { "unix_socket_falls_back_to_copy", UnixSocketFallsBackToCopy }
+    });
+}
@@ -0,0 +1,220 @@
+#include <common/test.hpp>
+#include <pollmanager/manager/poll.hpp>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include <netinet/in.h>
+
+using namespace vsock;
+using namespace vsock::test;
+
+namespace {
+
+    ZeroCopySender::shared_buffer_t Payload(BufferPool& pool, const std::size_t size, const char fill) {
+        auto buffer = std::make_shared<IOBuffer>(pool.Acquire(size));
+        std::memset(buffer->Data(), fill, size);
+        buffer->Resize(size);
+        return buffer;
+    }
+
+    // UDP socket connected to a loopback port nobody listens on, its sends
+    // come back as ICMP port unreachable on the error queue
+    SocketID RefusedUdp() {
+        const SocketID closed_id = ::socket(AF_INET, SOCK_DGRAM, 0);
+        struct sockaddr_in address {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        VSOCK_CHECK(::bind(closed_id, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == 0);
+        VSOCK_CHECK(::getsockname(closed_id, reinterpret_cast<struct sockaddr*>(&address), &length) == 0);
+        closesocket(closed_id);
+
+        const SocketID socket_id = ::socket(AF_INET, SOCK_DGRAM, 0);
+        int one = 1;
+        VSOCK_CHECK(::setsockopt(socket_id, SOL_IP, IP_RECVERR, &one, sizeof(one)) == 0);
+        VSOCK_CHECK(::connect(socket_id, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == 0);
+        SetNonBlocking(socket_id);
+        return socket_id;
+    }
+
+    // Loopback copies the data but still reports the completion
+    void CompletionsReleaseBuffers() {
+        BufferPool pool;
+        auto [socket_id, peer_id] = TcpPair();
+        ZeroCopySender sender(socket_id);
+        if (!sender.Enabled()) {
+            std::printf("SO_ZEROCOPY is not supported, plain sends are checked\n");
+        }
+
+        const ZeroCopySender::shared_buffer_t buffer = Payload(pool, 32768, 'z');
+        std::size_t sent = 0;
+        std::string received;
+        while (sent < buffer->Size()) {
+            const std::ptrdiff_t result = sender.Send(buffer, sent);
+            VSOCK_CHECK(result > 0 || VSOCK_WOULD_BLOCK());
+            if (result > 0) {
+                sent += static_cast<std::size_t>(result);
+            }
+            else {
+                received += RecvAll(peer_id, 1);
+            }
+        }
+        received += RecvAll(peer_id, buffer->Size() - received.size());
+        VSOCK_CHECK(received == std::string(buffer->Size(), 'z'));
+        VSOCK_CHECK(Eventually([&sender]() {
+            sender.DrainCompletions();
+            return sender.Pending() == 0;
+        }));
+
+        closesocket(socket_id);
+        closesocket(peer_id);
+    }
+
+    // The error queue EPOLLERR disarms a ONESHOT socket like any other event
+    void OneshotSocketIsRearmed() {
+        ThreadPool threads(2);
+        BufferPool pool;
+        std::atomic<std::size_t> handled{ 0 };
+        std::atomic<std::size_t> received{ 0 };
+        auto [socket_id, peer_id] = TcpPair();
+        {
+            PollManager poll(&threads, &pool);
+            poll.Add(socket_id, EPOLLIN | EPOLLONESHOT, [&](const SocketID id) {
+                char data[256];
+                ssize_t result;
+                while ((result = ::recv(id, data, sizeof(data), 0)) > 0) {
+                    received += static_cast<std::size_t>(result);
+                }
+                ++handled;
+                poll.ResetFlags(id);
+            });
+            poll.EnableZeroCopy(socket_id);
+
+            const ZeroCopySender::shared_buffer_t buffer = Payload(pool, 32768, 'z');
+            std::size_t sent = 0;
+            while (sent < buffer->Size()) {
+                const std::ptrdiff_t result = poll.SendZeroCopy(socket_id, buffer, sent);
+                if (result > 0) {
+                    sent += static_cast<std::size_t>(result);
+                }
+            }
+            VSOCK_CHECK(RecvAll(peer_id, buffer->Size()).size() == buffer->Size());
+            // Let the completion arrive on its own before the peer writes
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            VSOCK_CHECK(handled == 0);
+
+            SendAll(peer_id, "ping");
+            VSOCK_CHECK(Eventually([&]() { return received == 4; }));
+            SendAll(peer_id, "pong");
+            VSOCK_CHECK(Eventually([&]() { return received == 8; }));
+        }
+        closesocket(peer_id);
+    }
+
+    // Completions queued while the handler runs come back as EPOLLIN|EPOLLERR
+    // with the next data, that must not look like a hangup
+    void CompletionsNextToDataAreNotAHangup() {
+        ThreadPool threads(2);
+        BufferPool pool;
+        std::atomic<bool> proceed{ false };
+        std::atomic<bool> closed{ false };
+        std::atomic<std::size_t> received{ 0 };
+        auto [socket_id, peer_id] = TcpPair();
+        {
+            PollManager poll(&threads, &pool);
+            poll.Add(socket_id, EPOLLIN | EPOLLONESHOT, [&](const SocketID id) {
+                char data[256];
+                ssize_t result;
+                while ((result = ::recv(id, data, sizeof(data), 0)) > 0) {
+                    received += static_cast<std::size_t>(result);
+                }
+                while (!proceed) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                poll.ResetFlags(id);
+            }, PollManager::Priority::NORMAL, [&closed](const SocketID, const std::uint32_t) {
+                closed = true;
+            });
+            poll.EnableZeroCopy(socket_id);
+
+            SendAll(peer_id, "a");
+            VSOCK_CHECK(Eventually([&]() { return received == 1; }));
+            // The handler holds the socket disarmed while both become pending
+            const ZeroCopySender::shared_buffer_t buffer = Payload(pool, 32768, 'z');
+            std::size_t sent = 0;
+            while (sent < buffer->Size()) {
+                const std::ptrdiff_t result = poll.SendZeroCopy(socket_id, buffer, sent);
+                if (result > 0) {
+                    sent += static_cast<std::size_t>(result);
+                }
+            }
+            VSOCK_CHECK(RecvAll(peer_id, buffer->Size()).size() == buffer->Size());
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            SendAll(peer_id, "b");
+            proceed = true;
+
+            VSOCK_CHECK(Eventually([&]() { return received == 2; }));
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            VSOCK_CHECK(!closed);
+
+            // A real hangup still reaches the close handler
+            ::shutdown(peer_id, SHUT_WR);
+            VSOCK_CHECK(Eventually([&]() { return closed.load(); }));
+        }
+        closesocket(peer_id);
+    }
+
+    // An ICMP error drained next to the completions is counted, not dropped
+    void ForeignErrorsAreCounted() {
+        BufferPool pool;
+        const SocketID socket_id = RefusedUdp();
+        ZeroCopySender sender(socket_id);
+        const ZeroCopySender::shared_buffer_t buffer = Payload(pool, 32768, 'u');
+        VSOCK_CHECK(sender.Send(buffer, 0) == static_cast<std::ptrdiff_t>(buffer->Size()));
+        VSOCK_CHECK(Eventually([&]() {
+            sender.DrainCompletions();
+            return sender.Errors() == 1;
+        }));
+        VSOCK_CHECK(sender.LastError() == ECONNREFUSED);
+        VSOCK_CHECK(Eventually([&]() {
+            sender.DrainCompletions();
+            return sender.Pending() == 0;
+        }));
+        closesocket(socket_id);
+    }
+
+    // Taking the error off the queue clears SO_ERROR, it must still reach the close handler
+    void ForeignErrorsReachCloseHandler() {
+        ThreadPool threads(2);
+        BufferPool pool;
+        const SocketID socket_id = RefusedUdp();
+        std::atomic<std::uint32_t> close_events{ 0 };
+        {
+            PollManager poll(&threads, &pool);
+            poll.Add(socket_id, EPOLLIN | EPOLLONESHOT, [&poll](const SocketID id) {
+                poll.ResetFlags(id);
+            }, PollManager::Priority::NORMAL, [&close_events](const SocketID, const std::uint32_t events) {
+                close_events = events;
+            });
+            poll.EnableZeroCopy(socket_id);
+
+            const ZeroCopySender::shared_buffer_t buffer = Payload(pool, 32768, 'u');
+            VSOCK_CHECK(poll.SendZeroCopy(socket_id, buffer, 0) == static_cast<std::ptrdiff_t>(buffer->Size()));
+            VSOCK_CHECK(Eventually([&]() { return (close_events & EPOLLERR) != 0; }));
+        }
+    }
+
+}
+
+int main() {
+    return Run({
+        { "completions_release_buffers", CompletionsReleaseBuffers },
+        { "oneshot_socket_is_rearmed", OneshotSocketIsRearmed },
+        { "completions_next_to_data_are_not_a_hangup", CompletionsNextToDataAreNotAHangup },
+        { "foreign_errors_are_counted", ForeignErrorsAreCounted },
+        { "foreign_errors_reach_close_handler", ForeignErrorsReachCloseHandler }
+    });
+}